@@ -0,0 +1,52 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_ALTERNATIVE_ROUTES_H
+#define OSM_ALTERNATIVE_ROUTES_H
+
+#include <osm_planner/graph_search.h>
+
+#include <vector>
+
+namespace osm_planner {
+
+    //Plateau method - shortest path trees from source and from target are computed once.
+    //Chain of edges, which is in both trees (plateau), gives alternative route:
+    //source -> plateau start (source tree), plateau, plateau end -> target (target tree).
+    //Long plateaus give natural alternatives without zig-zags.
+    class AlternativeRoutes {
+    public:
+
+        //max_stretch - length of alternative / length of shortest path
+        //max_share - max part of alternative, which can be shared with any selected route
+        AlternativeRoutes(int max_routes = 2, double max_stretch = 1.4, double max_share = 0.7);
+
+        //shortest path first, followed by up to max_routes alternatives, throws dijkstra_exception::NO_PATH_FOUND
+        std::vector<std::vector<int> > findRoutes(const IntegerGraph &graph, int src, int target);
+
+    private:
+
+        typedef struct plateau {
+            int start;
+            int end;
+            unsigned int length;        //length of plateau
+            unsigned int route_length;  //length of whole alternative route
+        } PLATEAU;
+
+        int max_routes;
+        double max_stretch;
+        double max_share;
+
+        RadixHeapSearch forward;    //tree from source
+        RadixHeapSearch backward;   //tree from target, the graph is undirected
+
+        std::vector<int> getRoute(const PLATEAU &plateau);
+        static bool isSimple(const std::vector<int> &route, int size);
+        static unsigned int getSharedLength(const IntegerGraph &graph, const std::vector<int> &route, const std::vector<int> &other);
+        static unsigned int getLength(const IntegerGraph &graph, const std::vector<int> &route);
+        static bool compareByLength(const PLATEAU &a, const PLATEAU &b);
+    };
+}
+
+#endif //OSM_ALTERNATIVE_ROUTES_H
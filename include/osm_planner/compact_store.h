@@ -0,0 +1,205 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_COMPACT_STORE_H
+#define OSM_COMPACT_STORE_H
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+namespace osm_planner {
+
+    //Coordinates of nodes in fixed point 1e-7 deg like in OSM (about 1 cm), latitudes and longitudes
+    //are in separate arrays - 8 bytes per node. N is type of node with latitude and longitude,
+    //nodes are returned by const value, so they can't be changed by assignment, only by set(), other fields of N are 0.
+    template<class N>
+    class NodeStore {
+    public:
+
+        constexpr static double SCALE = 1e7;
+
+        NodeStore() {
+            refresh();
+        }
+
+        NodeStore(const NodeStore &other) {
+            *this = other;
+        }
+
+        NodeStore &operator=(const NodeStore &other) {
+
+            latitudes = other.latitudes;
+            longitudes = other.longitudes;
+            count = other.count;
+            attached = other.attached;
+            latitudes_data = other.latitudes_data;
+            longitudes_data = other.longitudes_data;
+            if (!attached)
+                refresh();
+            return *this;
+        }
+
+        //arrays of other owner (shared memory) aren't copied, they are copied before the first change
+        void attach(int size, const int *latitudes, const int *longitudes) {
+
+            this->latitudes.clear();
+            this->longitudes.clear();
+            count = size;
+            latitudes_data = latitudes;
+            longitudes_data = longitudes;
+            attached = true;
+        }
+
+        bool isAttached() const {
+
+            return attached;
+        }
+
+        int size() const {
+
+            return count;
+        }
+
+        bool empty() const {
+
+            return count == 0;
+        }
+
+        void clear() {
+
+            latitudes.clear();
+            longitudes.clear();
+            refresh();
+        }
+
+        void resize(int size) {
+
+            detach();
+            latitudes.resize(size, 0);
+            longitudes.resize(size, 0);
+            refresh();
+        }
+
+        //buffers of vectors are exchanged, so the pointers stay valid
+        void swap(NodeStore &other) {
+
+            latitudes.swap(other.latitudes);
+            longitudes.swap(other.longitudes);
+            std::swap(count, other.count);
+            std::swap(attached, other.attached);
+            std::swap(latitudes_data, other.latitudes_data);
+            std::swap(longitudes_data, other.longitudes_data);
+        }
+
+        void push_back(const N &node) {
+
+            detach();
+            latitudes.push_back(encode(node.latitude));
+            longitudes.push_back(encode(node.longitude));
+            refresh();
+        }
+
+        void set(int id, const N &node) {
+
+            detach();
+            latitudes[id] = encode(node.latitude);
+            longitudes[id] = encode(node.longitude);
+        }
+
+        const N operator[](int id) const {
+
+            N node = N();
+            node.latitude = latitudes_data[id] / SCALE;
+            node.longitude = longitudes_data[id] / SCALE;
+            return node;
+        }
+
+        double getLatitude(int id) const {
+
+            return latitudes_data[id] / SCALE;
+        }
+
+        double getLongitude(int id) const {
+
+            return longitudes_data[id] / SCALE;
+        }
+
+        //fixed point arrays, e.g. for copy to shared memory
+        const int *getLatitudes() const {
+
+            return latitudes_data;
+        }
+
+        const int *getLongitudes() const {
+
+            return longitudes_data;
+        }
+
+        //own memory, attached arrays aren't counted
+        size_t getMemory() const {
+
+            return (latitudes.capacity() + longitudes.capacity()) * sizeof(int);
+        }
+
+    private:
+
+        std::vector<int> latitudes;
+        std::vector<int> longitudes;
+
+        //arrays used by getters - data of own vectors or attached arrays
+        int count;
+        bool attached;
+        const int *latitudes_data;
+        const int *longitudes_data;
+
+        void refresh() {
+
+            count = latitudes.size();
+            attached = false;
+            latitudes_data = latitudes.empty() ? NULL : &latitudes[0];
+            longitudes_data = longitudes.empty() ? NULL : &longitudes[0];
+        }
+
+        void detach() {
+
+            if (!attached)
+                return;
+
+            latitudes.assign(latitudes_data, latitudes_data + count);
+            longitudes.assign(longitudes_data, longitudes_data + count);
+            refresh();
+        }
+
+        static int encode(double degrees) {
+
+            return (int) lround(degrees * SCALE);
+        }
+    };
+
+    //Immutable lists of integers in one arena. Every list is count and differences of neighbouring values,
+    //all as zigzag varints, so IDs of nearby osm nodes take mostly 1 - 3 bytes.
+    class VarintArena {
+    public:
+
+        //returns index of the list
+        int append(const std::vector<int> &list);
+        void get(int index, std::vector<int> *list) const;
+
+        int size() const;
+        void clear();
+        size_t getMemory() const;
+
+    private:
+
+        std::vector<unsigned char> bytes;
+        std::vector<unsigned int> offsets;      //start of every list in bytes
+
+        void writeVarint(long long value);
+        long long readVarint(size_t *position) const;
+    };
+}
+
+#endif //OSM_COMPACT_STORE_H
@@ -0,0 +1,67 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_DELTA_STEPPING_H
+#define OSM_DELTA_STEPPING_H
+
+#include <osm_planner/graph_search.h>
+
+#include <boost/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace osm_planner {
+
+    //Parallel Δ-stepping single source search on integer adjacency lists.
+    //Nodes are kept in buckets of width delta, all nodes of the lowest bucket are relaxed at once -
+    //first light edges (weight <= delta) until the bucket is empty, then heavy edges.
+    //Relaxations are collected by all threads in parallel and applied by one thread.
+    class DeltaStepping {
+    public:
+
+        //delta in graph units (centimetres)
+        DeltaStepping(int threads = 1, unsigned int delta = 1000);
+
+        //distances from src to all nodes up to max_distance, the others stay IntegerGraph::INFINITY_WEIGHT
+        void findDistances(const IntegerGraph &graph, int src, unsigned int max_distance = IntegerGraph::INFINITY_WEIGHT);
+
+        const std::vector<unsigned int> &getDistances();
+        const std::vector<int> &getParents();
+
+    private:
+
+        typedef struct request {
+            int node;
+            int parent;
+            unsigned int distance;
+        } REQUEST;
+
+        //smaller frontier is relaxed by the calling thread only, synchronization would cost more than the work
+        const static int PARALLEL_FRONTIER = 256;
+
+        int threads;
+        unsigned int delta;
+
+        std::vector<unsigned int> distance;
+        std::vector<int> parent;
+        std::vector<std::vector<int> > buckets;
+        std::vector<int> stamp;             //deduplication of nodes in frontier
+
+        //current phase shared with workers
+        const IntegerGraph *graph;
+        unsigned int max_distance;
+        std::vector<int> frontier;
+        bool light_phase;
+        bool finished;
+        std::vector<std::vector<REQUEST> > requests;    //[thread]
+        boost::shared_ptr<boost::barrier> barrier;
+
+        void worker(int id);
+        void runPhase();
+        void collectRequests(int id, int parts);
+        void relaxRequests(int parts);
+    };
+}
+
+#endif //OSM_DELTA_STEPPING_H
@@ -17,6 +17,11 @@
 #include <vector>
 #include <iostream>
 #include <exception>
+#include <limits>
+#include <algorithm>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
 
 // A utility function to find the vertex with minimum distance
 // value, from the set of vertices not yet included in shortest
@@ -27,12 +32,15 @@ namespace osm_planner {
     class dijkstra_exception : public std::exception {
     public:
         const static int NO_PATH_FOUND = 1;
+        const static int SEARCH_CANCELLED = 2;
 
         dijkstra_exception(int err_id) {
             this->err_id = err_id;
         }
 
         virtual const char *what() const throw() {
+            if (err_id == SEARCH_CANCELLED)
+                return "Search was cancelled";
             return "No path found";
         }
 
@@ -49,20 +57,46 @@ namespace osm_planner {
 
         Dijkstra();
 
-        std::vector<int> findShortestPath(std::vector<std::vector<float> > *graph, int src, int target);
+        //with heuristic (lower bound of distance from every vertex to the target) it is A* algorithm
+        std::vector<int> findShortestPath(std::vector<std::vector<float> > *graph, int src, int target, const std::vector<float> *heuristic = NULL);
 
         std::vector<int> getSolution();
 
+        //estimated distance of every vertex to the goal - for tracking the best partial solution, empty vector disables it
+        void setGoalDistance(const std::vector<float> &goal_distance);
+
+        //running search throws dijkstra_exception::SEARCH_CANCELLED, flag is kept until setCancelled(false)
+        void setCancelled(bool cancelled);
+
+        //path from source to the processed vertex nearest to the goal, thread safe - can be called during the search
+        std::vector<int> getPartialSolution();
+
+        //one-to-many search - distances from src to all targets in one search (INFINITY_DISTANCE if unreachable)
+        std::vector<float> findDistances(std::vector<std::vector<float> > *graph, int src, const std::vector<int> &targets);
+
+        //path from the source of last findDistances() call to target, empty if target isn't reachable
+        std::vector<int> getPathTo(int target);
+
+        static constexpr float INFINITY_DISTANCE = std::numeric_limits<float>::max();
+
     private:
 
         std::vector<int> path;      // The shortest path - initialize in function getShortestPath()
         int source;                 //start point
 
-        int minDistance(std::vector<float> dist, bool sptSet[]);
+        std::vector<int> parent;    // shortest path tree of last search
+        std::vector<float> distance;
+
+        std::vector<float> goal_distance;
+        boost::atomic<bool> cancelled;
+        boost::atomic<int> best_node;   //processed vertex nearest to the goal
+        boost::mutex progress_mutex;    //guards reallocation of the arrays against getPartialSolution()
+
+        int minDistance(const std::vector<float> &dist, const std::vector<bool> &sptSet, const std::vector<float> *heuristic = NULL);
 
-        std::vector<int> getSolution(std::vector<int> parent, std::vector<float> dist, int target);
+        std::vector<int> getSolution(int target);
 
-        void printPath(std::vector<int> parent, int j);
+        void printPath(int j);
     };
 
 }
@@ -0,0 +1,65 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_DISTANCE_FIELD_H
+#define OSM_DISTANCE_FIELD_H
+
+#include <osm_planner/osm_parser.h>
+
+#include <vector>
+
+namespace osm_planner {
+
+    //Raster of distances from cells to the nearest segment of way in the map frame. Cells along edges are seeded,
+    //nearest edges are propagated to neighbours by two raster passes (Danielsson), the distance of cell is exact distance
+    //from its centre to the propagated edge. Query is one lookup, error is at most half of cell diagonal.
+    //Memory is (4 + 4) bytes per cell, the raster covers nodes with margin.
+    class DistanceField {
+    public:
+
+        typedef struct edge {
+            int source;
+            int target;
+        } EDGE;
+
+        DistanceField();
+
+        //field of ways, so it must be rebuilt after ways are changed or origin is changed (x, y of nodes by the calculator),
+        //not after edge is deleted, resolution is increased, if the raster would have more than max_cells cells
+        void build(Parser::GRAPH *graph, Parser::Haversine *calculator, double resolution, double margin, long max_cells);
+
+        //[m] to the nearest edge, negative out of the raster or without edges
+        float getDistance(double x, double y) const;
+
+        //false out of the raster or without edges
+        bool getNearestEdge(double x, double y, EDGE *edge) const;
+
+        unsigned long getVersion() const;   //of the graph, which the field was built from
+        double getResolution() const;
+        long getMemory() const;
+
+    private:
+
+        typedef struct segment {
+            EDGE edge;
+            double ax, ay, bx, by;
+        } SEGMENT;
+
+        double min_x, min_y;
+        double resolution;
+        int rows, cols;
+        unsigned long version;
+
+        std::vector<SEGMENT> segments;
+        std::vector<float> distances;       //[row * cols + col]
+        std::vector<int> nearest;           //[row * cols + col] - index of segment, -1 none
+
+        void addSegment(int u, int v, const std::vector<double> &xs, const std::vector<double> &ys);
+        long getCell(double x, double y) const;
+        double getSegmentDistance(int segment, int row, int col) const;
+        void relax(int row, int col, int from_row, int from_col);
+    };
+}
+
+#endif //OSM_DISTANCE_FIELD_H
@@ -0,0 +1,60 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_EXECUTOR_H
+#define OSM_EXECUTOR_H
+
+#include <ros/ros.h>
+#include <ros/callback_queue.h>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace osm_planner {
+
+    //Callback queues of planner node with own threads, so slow planning or visualization doesn't delay
+    //gps and odometry. Localization (gps, odom, pose updates) has one thread, so messages are processed in order,
+    //planning services have planning_threads threads and visualization publishing has one thread.
+    class Executor {
+    public:
+
+        Executor();
+        ~Executor();
+
+        ros::CallbackQueue *getLocalizationQueue();
+        ros::CallbackQueue *getPlanningQueue();
+        ros::CallbackQueue *getVisualizationQueue();
+
+        void start(int planning_threads);
+
+        //waits for running callbacks, it must be called before objects of callbacks are destroyed
+        void stop();
+
+        //function is called by thread of the queue
+        static void post(ros::CallbackQueueInterface *queue, boost::function<void()> function);
+
+    private:
+
+        ros::CallbackQueue localization_queue;
+        ros::CallbackQueue planning_queue;
+        ros::CallbackQueue visualization_queue;
+
+        boost::shared_ptr<ros::AsyncSpinner> localization_spinner;
+        boost::shared_ptr<ros::AsyncSpinner> planning_spinner;
+        boost::shared_ptr<ros::AsyncSpinner> visualization_spinner;
+
+        class FunctionCallback : public ros::CallbackInterface {
+        public:
+            FunctionCallback(boost::function<void()> function) : function(function) {}
+            CallResult call();
+        private:
+            boost::function<void()> function;
+        };
+
+        Executor(const Executor &);
+        Executor &operator=(const Executor &);
+    };
+}
+
+#endif //OSM_EXECUTOR_H
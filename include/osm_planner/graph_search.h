@@ -0,0 +1,516 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_GRAPH_SEARCH_H
+#define OSM_GRAPH_SEARCH_H
+
+#include <osm_planner/dijkstra.h>
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace osm_planner {
+
+    //Compressed adjacency lists (CSR) of the road network.
+    //Edges of node u are targets[begin(u)] ... targets[end(u) - 1]. Every node has own block with free slots,
+    //so edges can be added in place. Full block is moved to the end of arrays with doubled capacity.
+    //Graph can also read arrays of other owner (shared memory), they are copied before the first change.
+    template<class W>
+    class AdjacencyGraph {
+    public:
+
+        typedef W weight_type;
+
+        AdjacencyGraph() : max_weight(0) {
+            refresh();
+        }
+
+        AdjacencyGraph(const AdjacencyGraph &other) {
+            *this = other;
+        }
+
+        AdjacencyGraph &operator=(const AdjacencyGraph &other) {
+
+            offsets = other.offsets;
+            ends = other.ends;
+            capacities = other.capacities;
+            targets = other.targets;
+            weights = other.weights;
+            max_weight = other.max_weight;
+            count = other.count;
+            slots = other.slots;
+            attached = other.attached;
+
+            offsets_data = other.offsets_data;
+            ends_data = other.ends_data;
+            targets_data = other.targets_data;
+            weights_data = other.weights_data;
+            if (!attached)
+                refresh();
+            return *this;
+        }
+
+        //arrays aren't copied, they must live until the graph is changed or destroyed, slots - length of targets and weights
+        void attach(int size, int slots, const int *offsets, const int *ends, const int *targets, const W *weights, W max_weight) {
+
+            this->offsets.clear();
+            this->ends.clear();
+            this->capacities.clear();
+            this->targets.clear();
+            this->weights.clear();
+
+            count = size;
+            this->slots = slots;
+            this->max_weight = max_weight;
+            offsets_data = offsets;
+            ends_data = ends;
+            targets_data = targets;
+            weights_data = weights;
+            attached = true;
+        }
+
+        bool isAttached() const { return attached; }
+
+        //weight of edge in graph = metres * scale (1 for float, 100 for centimetres), slack - free slots of every node
+        void build(std::vector<std::vector<float> > *graph, double scale = 1, int slack = 0) {
+
+            int size = graph->size();
+            attached = false;
+            offsets.assign(size, 0);
+            ends.assign(size, 0);
+            capacities.assign(size, 0);
+            targets.clear();
+            weights.clear();
+            max_weight = 0;
+
+            for (int u = 0; u < size; u++) {
+                offsets[u] = targets.size();
+                const std::vector<float> &edges = (*graph)[u];
+                for (int v = 0; v < size; v++) {
+                    if (edges[v]) {
+                        W weight = toWeight(edges[v] * scale);
+                        targets.push_back(v);
+                        weights.push_back(weight);
+                        max_weight = std::max(max_weight, weight);
+                    }
+                }
+                ends[u] = targets.size();
+                targets.resize(ends[u] + slack, -1);
+                weights.resize(ends[u] + slack, INFINITY_WEIGHT);
+                capacities[u] = targets.size() - offsets[u];
+            }
+            refresh();
+        }
+
+        //edge is only disabled, structure of arrays stays the same
+        void deleteEdge(int u, int v) {
+
+            detach();
+            for (int e = offsets[u]; e < ends[u]; e++) {
+                if (targets[e] == v)
+                    weights[e] = INFINITY_WEIGHT;
+            }
+        }
+
+        //new node without edges, returns its ID
+        int addNode() {
+
+            detach();
+            offsets.push_back(targets.size());
+            ends.push_back(targets.size());
+            capacities.push_back(0);
+            refresh();
+            return offsets.size() - 1;
+        }
+
+        //weight of new or existing edge u -> v in units of graph (metres * scale)
+        void setEdge(int u, int v, double weight) {
+
+            detach();
+            W w = toWeight(weight);
+            max_weight = std::max(max_weight, w);
+
+            for (int e = offsets[u]; e < ends[u]; e++) {
+                if (targets[e] == v) {
+                    weights[e] = w;
+                    return;
+                }
+            }
+
+            if (ends[u] - offsets[u] == capacities[u])
+                moveBlock(u, std::max(2 * capacities[u], 4));
+
+            targets[ends[u]] = v;
+            weights[ends[u]] = w;
+            ends[u]++;
+        }
+
+        //the last edge of node takes the slot of removed edge
+        void removeEdge(int u, int v) {
+
+            detach();
+            for (int e = offsets[u]; e < ends[u]; e++) {
+                if (targets[e] == v) {
+                    ends[u]--;
+                    targets[e] = targets[ends[u]];
+                    weights[e] = weights[ends[u]];
+                    targets[ends[u]] = -1;
+                    weights[ends[u]] = INFINITY_WEIGHT;
+                    return;
+                }
+            }
+        }
+
+        //INFINITY_WEIGHT if there is no edge
+        W getWeight(int u, int v) const {
+
+            for (int e = offsets_data[u]; e < ends_data[u]; e++) {
+                if (targets_data[e] == v)
+                    return weights_data[e];
+            }
+            return INFINITY_WEIGHT;
+        }
+
+        int size() const { return count; }
+        int begin(int u) const { return offsets_data[u]; }
+        int end(int u) const { return ends_data[u]; }
+        int target(int e) const { return targets_data[e]; }
+        W weight(int e) const { return weights_data[e]; }
+        W getMaxWeight() const { return max_weight; }
+        int getSlots() const { return slots; }      //length of arrays of edges including free slots
+
+        static const W INFINITY_WEIGHT;
+
+    private:
+
+        std::vector<int> offsets;       //first slot of block of node
+        std::vector<int> ends;          //first free slot of block of node
+        std::vector<int> capacities;    //count of slots in block of node
+        std::vector<int> targets;
+        std::vector<W> weights;
+        W max_weight;                   //upper bound, it isn't decreased by removing of edges
+
+        //arrays used by getters - data of own vectors or attached arrays
+        int count, slots;
+        bool attached;
+        const int *offsets_data;
+        const int *ends_data;
+        const int *targets_data;
+        const W *weights_data;
+
+        //pointers to own vectors, after every reallocation
+        void refresh() {
+
+            count = offsets.size();
+            slots = targets.size();
+            attached = false;
+            offsets_data = offsets.empty() ? NULL : &offsets[0];
+            ends_data = ends.empty() ? NULL : &ends[0];
+            targets_data = targets.empty() ? NULL : &targets[0];
+            weights_data = weights.empty() ? NULL : &weights[0];
+        }
+
+        //copy of attached arrays before the first change
+        void detach() {
+
+            if (!attached)
+                return;
+
+            offsets.assign(offsets_data, offsets_data + count);
+            ends.assign(ends_data, ends_data + count);
+            targets.assign(targets_data, targets_data + slots);
+            weights.assign(weights_data, weights_data + slots);
+            capacities.resize(count);
+            for (int u = 0; u < count; u++) {
+                capacities[u] = ends[u] - offsets[u];
+            }
+            refresh();
+        }
+
+        //old block stays unused until the next build
+        void moveBlock(int u, int capacity) {
+
+            int start = targets.size();
+            targets.resize(start + capacity, -1);
+            weights.resize(start + capacity, INFINITY_WEIGHT);
+
+            int edges = ends[u] - offsets[u];
+            for (int i = 0; i < edges; i++) {
+                targets[start + i] = targets[offsets[u] + i];
+                weights[start + i] = weights[offsets[u] + i];
+            }
+
+            offsets[u] = start;
+            ends[u] = start + edges;
+            capacities[u] = capacity;
+            refresh();
+        }
+
+        //integer weights are rounded, but never to zero - zero means missing edge in matrix
+        static W toWeight(double weight) {
+            if (std::numeric_limits<W>::is_integer)
+                return std::max<W>(1, (W) std::floor(weight + 0.5));
+            return (W) weight;
+        }
+    };
+
+    template<class W>
+    const W AdjacencyGraph<W>::INFINITY_WEIGHT = std::numeric_limits<W>::max();
+
+    //---------------------------------------------------------------//
+    //--------------Priority queues for the search kernel------------//
+    //---------------------------------------------------------------//
+
+    //Comparison heap, works for any weight type. Decrease key is done by inserting
+    //new entry, old entries are skipped by the search.
+    template<class W>
+    class BinaryHeapQueue {
+    public:
+
+        void init(W max_edge_weight) { clear(); }
+        void clear() { heap = std::priority_queue<ENTRY>(); }
+        bool empty() const { return heap.empty(); }
+        void push(W key, int node) { heap.push(ENTRY(key, node)); }
+
+        int pop(W *key) {
+            ENTRY top = heap.top();
+            heap.pop();
+            *key = top.key;
+            return top.node;
+        }
+
+    private:
+
+        struct ENTRY {
+            W key;
+            int node;
+            ENTRY(W key, int node) : key(key), node(node) {}
+            bool operator<(const ENTRY &other) const { return key > other.key; }
+        };
+
+        std::priority_queue<ENTRY> heap;
+    };
+
+    //Monotone radix heap for unsigned integer keys. Every popped key is >= last popped key,
+    //so the entry is moved only to buckets with lower index - amortized O(log C) per entry.
+    template<class W>
+    class RadixHeapQueue {
+    public:
+
+        RadixHeapQueue() : buckets(BITS + 1), last(0), count(0) {}
+
+        void init(W max_edge_weight) { clear(); }
+
+        void clear() {
+            for (int i = 0; i <= BITS; i++) buckets[i].clear();
+            last = 0;
+            count = 0;
+        }
+
+        bool empty() const { return count == 0; }
+
+        void push(W key, int node) {
+            buckets[bucket(key)].push_back(ENTRY(key, node));
+            count++;
+        }
+
+        int pop(W *key) {
+
+            if (buckets[0].empty()) {
+
+                int i = 1;
+                while (buckets[i].empty()) i++;
+
+                //new minimum - all entries of the bucket are redistributed to lower buckets
+                W min = buckets[i][0].key;
+                for (int j = 1; j < buckets[i].size(); j++)
+                    min = std::min(min, buckets[i][j].key);
+                last = min;
+
+                for (int j = 0; j < buckets[i].size(); j++)
+                    buckets[bucket(buckets[i][j].key)].push_back(buckets[i][j]);
+                buckets[i].clear();
+            }
+
+            ENTRY entry = buckets[0].back();
+            buckets[0].pop_back();
+            count--;
+            *key = entry.key;
+            return entry.node;
+        }
+
+    private:
+
+        struct ENTRY {
+            W key;
+            int node;
+            ENTRY(W key, int node) : key(key), node(node) {}
+        };
+
+        static const int BITS = std::numeric_limits<W>::digits;
+
+        std::vector<std::vector<ENTRY> > buckets;
+        W last;
+        int count;
+
+        //index of highest bit in which key differs from last popped key
+        int bucket(W key) const {
+            W diff = key ^ last;
+            int b = 0;
+            while (diff) {
+                diff >>= 1;
+                b++;
+            }
+            return b;
+        }
+    };
+
+    //Dial's bucket queue - circular array of max_edge_weight + 1 buckets with unsigned integer keys.
+    //All keys in the queue are in range [min, min + max_edge_weight], so every bucket holds only one key.
+    template<class W>
+    class BucketQueue {
+    public:
+
+        BucketQueue() : current(0), count(0) {}
+
+        void init(W max_edge_weight) {
+            buckets.resize((size_t) max_edge_weight + 1);
+            clear();
+        }
+
+        void clear() {
+            for (int i = 0; i < buckets.size(); i++) buckets[i].clear();
+            current = 0;
+            count = 0;
+        }
+
+        bool empty() const { return count == 0; }
+
+        void push(W key, int node) {
+            buckets[key % buckets.size()].push_back(node);
+            count++;
+        }
+
+        int pop(W *key) {
+
+            while (buckets[current % buckets.size()].empty()) current++;
+
+            std::vector<int> &bucket = buckets[current % buckets.size()];
+            int node = bucket.back();
+            bucket.pop_back();
+            count--;
+            *key = current;
+            return node;
+        }
+
+    private:
+
+        std::vector<std::vector<int> > buckets;
+        W current;
+        int count;
+    };
+
+    //---------------------------------------------------------------//
+    //---------------Search kernel on adjacency graph----------------//
+    //---------------------------------------------------------------//
+
+    //Dijkstra algorithm specialised at compile time for the weight type and the priority queue.
+    //Object keeps its arrays between searches, so it is workspace of one running search.
+    template<class W, class Queue>
+    class GraphSearch {
+    public:
+
+        GraphSearch() : source(-1) {}
+
+        std::vector<int> findShortestPath(const AdjacencyGraph<W> &graph, int src, int target) {
+
+            search(graph, src, target);
+
+            if (distance[target] == AdjacencyGraph<W>::INFINITY_WEIGHT)
+                throw dijkstra_exception(dijkstra_exception::NO_PATH_FOUND);
+
+            std::vector<int> nodes;
+            for (int v = target; v != -1; v = parent[v]) {
+                nodes.push_back(v);
+            }
+            std::reverse(nodes.begin(), nodes.end());
+            return nodes;
+        }
+
+        //shortest path tree from src to all nodes
+        void findDistances(const AdjacencyGraph<W> &graph, int src) {
+
+            search(graph, src, -1);
+        }
+
+        //distance in graph units of last search
+        W getDistance(int target) { return distance[target]; }
+
+        const std::vector<W> &getDistances() { return distance; }
+        const std::vector<int> &getParents() { return parent; }
+
+    private:
+
+        int source;
+        std::vector<int> parent;
+        std::vector<W> distance;
+        std::vector<bool> settled;
+        Queue queue;
+
+        //target -1 - search whole graph
+        void search(const AdjacencyGraph<W> &graph, int src, int target) {
+
+            int size = graph.size();
+            source = src;
+            parent.assign(size, -1);
+            distance.assign(size, AdjacencyGraph<W>::INFINITY_WEIGHT);
+            settled.assign(size, false);
+
+            queue.init(graph.getMaxWeight());
+            distance[src] = 0;
+            queue.push(0, src);
+
+            while (!queue.empty()) {
+
+                W key;
+                int u = queue.pop(&key);
+
+                //old entry of vertex, which was improved later
+                if (settled[u] || key != distance[u])
+                    continue;
+
+                settled[u] = true;
+                if (u == target)
+                    break;
+
+                for (int e = graph.begin(u); e < graph.end(u); e++) {
+
+                    W weight = graph.weight(e);
+                    if (weight == AdjacencyGraph<W>::INFINITY_WEIGHT)
+                        continue;
+
+                    int v = graph.target(e);
+                    if (!settled[v] && distance[u] + weight < distance[v]) {
+                        distance[v] = distance[u] + weight;
+                        parent[v] = u;
+                        queue.push(distance[v], v);
+                    }
+                }
+            }
+        }
+    };
+
+    //graph with integer centimetre weights
+    typedef AdjacencyGraph<unsigned int> IntegerGraph;
+    const static double INTEGER_GRAPH_SCALE = 100;
+
+    typedef GraphSearch<float, BinaryHeapQueue<float> > HeapSearch;
+    typedef GraphSearch<unsigned int, RadixHeapQueue<unsigned int> > RadixHeapSearch;
+    typedef GraphSearch<unsigned int, BucketQueue<unsigned int> > BucketSearch;
+}
+
+#endif //OSM_GRAPH_SEARCH_H
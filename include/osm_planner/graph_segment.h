@@ -0,0 +1,100 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_GRAPH_SEGMENT_H
+#define OSM_GRAPH_SEGMENT_H
+
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <string>
+
+namespace osm_planner {
+
+    //Compiled graph in POSIX shared memory. One process writes the immutable graph, other processes map it
+    //read-only and search directly on its arrays. New graph is written to the new segment with the same name
+    //and the old one is marked as replaced, its memory is freed after the last process unmaps it.
+    //Segment stays after the publisher exits, so attached planners survive its restart.
+    //
+    //Layout: HEADER, int latitudes[nodes], int longitudes[nodes], int offsets[nodes + 1],
+    //int targets[slots], unsigned int weights[slots]. Coordinates are in 1e-7 deg, weights in centimetres,
+    //edges of node u are offsets[u] ... offsets[u + 1] - 1.
+    class GraphSegment {
+    public:
+
+        typedef struct header {
+            char magic[8];
+            unsigned int layout;            //LAYOUT of the writer, other layout can't be attached
+            boost::atomic<int> state;       //WRITING, READY or REPLACED, shared by all processes
+            unsigned long version;          //version of the graph in the publisher
+            int nodes;
+            int slots;
+            unsigned int max_weight;
+            size_t size;                    //bytes of whole segment
+        } HEADER;
+
+        const static int WRITING = 0;
+        const static int READY = 1;
+        const static int REPLACED = 2;
+
+        const static unsigned int LAYOUT = 1;
+
+        ~GraphSegment();
+
+        //new writable segment, the previous one with the same name is replaced, NULL on error
+        static boost::shared_ptr<GraphSegment> create(std::string name, unsigned long version, int nodes, int slots, unsigned int max_weight);
+
+        //read-only mapping of ready segment, NULL if it doesn't exist yet or it isn't compatible
+        static boost::shared_ptr<GraphSegment> attach(std::string name);
+
+        //writer finishes the segment, attachers can use it from now
+        void setReady();
+
+        //publisher has written newer graph, attached processes should attach again
+        bool isReplaced() const;
+
+        std::string getName() const { return name; }
+        unsigned long getVersion() const { return header->version; }
+        int getNodes() const { return header->nodes; }
+        int getSlots() const { return header->slots; }
+        unsigned int getMaxWeight() const { return header->max_weight; }
+        size_t getSize() const { return header->size; }
+
+        //arrays are writable only in the segment from create()
+        int *getLatitudes() const { return latitudes; }
+        int *getLongitudes() const { return longitudes; }
+        int *getOffsets() const { return offsets; }
+        int *getTargets() const { return targets; }
+        unsigned int *getWeights() const { return weights; }
+
+    private:
+
+        std::string name;
+        void *address;
+        size_t size;
+
+        HEADER *header;
+        int *latitudes;
+        int *longitudes;
+        int *offsets;
+        int *targets;
+        unsigned int *weights;
+
+        const static char MAGIC[8];
+
+        GraphSegment(std::string name, void *address, size_t size);
+
+        //posix names start with slash
+        static std::string getShmName(std::string name);
+
+        //marks the current segment with the name as replaced
+        static void replace(std::string shm_name);
+
+        static size_t getSize(int nodes, int slots);
+
+        GraphSegment(const GraphSegment &);
+        GraphSegment &operator=(const GraphSegment &);
+    };
+}
+
+#endif //OSM_GRAPH_SEGMENT_H
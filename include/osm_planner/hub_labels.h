@@ -0,0 +1,56 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_HUB_LABELS_H
+#define OSM_HUB_LABELS_H
+
+#include <osm_planner/dijkstra.h>
+
+#include <vector>
+
+namespace osm_planner {
+
+    //Hub labeling computed by pruned landmark labeling.
+    //Every node has sorted list of hubs with distances, shortest path between two nodes
+    //goes through their common hub with minimal sum of distances - query is only merge of two lists.
+    //The graph is undirected, so forward and backward labels are the same.
+    class HubLabels {
+    public:
+
+        typedef struct label {
+            int hub;        //rank of hub node
+            float distance; //distance between node and hub
+            int parent;     //next node on the path to the hub, -1 for hub itself
+        } LABEL;
+
+        HubLabels();
+
+        void build(std::vector<std::vector<float> > *graph, unsigned long version);
+
+        //true only for the same version of graph
+        bool isReady(unsigned long version);
+
+        //Dijkstra::INFINITY_DISTANCE if target isn't reachable
+        float getDistance(int source, int target);
+
+        //shortest path as nodes IDs, empty if target isn't reachable
+        std::vector<int> getPath(int source, int target);
+
+        //count of all label entries
+        long getLabelsSize();
+
+    private:
+
+        int size;
+        unsigned long version;
+        std::vector<int> order;                     //rank -> node ID
+        std::vector<std::vector<LABEL> > labels;    //labels of every node sorted by rank of hub
+
+        float query(int source, int target, int *hub);
+        const LABEL *findLabel(int node, int hub);
+        void appendPathToHub(int node, int hub, std::vector<int> *path);
+    };
+}
+
+#endif //OSM_HUB_LABELS_H
@@ -0,0 +1,54 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_LANDMARKS_H
+#define OSM_LANDMARKS_H
+
+#include <osm_planner/dijkstra.h>
+
+#include <string>
+#include <vector>
+
+namespace osm_planner {
+
+    //ALT (A*, landmarks, triangle inequality) preprocessing.
+    //Distances from few landmarks to every node give lower bound of distance between any two nodes:
+    //d(u, t) >= |d(L, t) - d(L, u)|
+    class Landmarks {
+    public:
+
+        Landmarks();
+
+        //farthest-point selection of landmarks and one-to-all searches from them,
+        //structure version of the graph is kept for isReady()
+        void build(std::vector<std::vector<float> > *graph, int count, unsigned long version);
+
+        //tables are saved in binary file, the file is valid only for the same graph
+        bool save(std::string file);
+        bool load(std::string file, std::vector<std::vector<float> > *graph, unsigned long version);
+
+        //true only for the same structure version of graph, lower bounds of other ways aren't admissible,
+        //deleted edges only lengthen distances, so they don't change the structure version
+        bool isReady(unsigned long version);
+        int getCount();
+
+        //lower bound of distance from every node to the target (used as heuristic for A*)
+        void getLowerBounds(int target, std::vector<float> *bounds);
+
+    private:
+
+        int size;                                   //count of nodes in graph
+        unsigned long version;                      //structure version of graph, which tables are for
+        std::vector<int> landmarks;
+        std::vector<std::vector<float> > distances;  //[landmark][node]
+
+        //count of edges and total length of the graph, it identifies the graph in saved file
+        unsigned int edges;
+        double length;
+
+        void computeSignature(std::vector<std::vector<float> > *graph, unsigned int *edges, double *length);
+    };
+}
+
+#endif //OSM_LANDMARKS_H
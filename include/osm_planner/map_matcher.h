@@ -0,0 +1,98 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_MAP_MATCHER_H
+#define OSM_MAP_MATCHER_H
+
+#include <osm_planner/osm_parser.h>
+
+#include <boost/unordered_map.hpp>
+#include <deque>
+#include <vector>
+
+namespace osm_planner {
+
+    //Online map matching of gps fixes by hidden Markov model. States are edges within search radius of the fix,
+    //emission is gaussian in the distance of fix to edge, transition is exponential in the difference of route
+    //distance between projections and straight distance between fixes. Viterbi runs incrementally over the window
+    //of last fixes, so noisy fix between parallel footways doesn't switch the matched way.
+    //Route distances are from bounded searches, which are cached for nodes of candidates until the graph is changed.
+    class MapMatcher {
+    public:
+
+        typedef struct match {
+            int source;             //nodes of matched edge
+            int target;
+            int node;               //node of edge nearer to the projection
+            double offset;          //position of projection on edge, 0 - source, 1 - target
+            double distance;        //[m] from fix to edge
+            Parser::OSM_NODE point; //projection of fix
+        } MATCH;
+
+        MapMatcher(Parser *map);
+
+        //sigma [m] - default gps noise, beta [m] - expected difference of route and straight distance,
+        //time_budget [s] - transitions over the budget don't search routes, they use straight distance
+        void setParams(double sigma, double beta, double search_radius, int max_candidates, int window_size, double time_budget);
+
+        //false if there is no edge within search radius, sigma <= 0 - default sigma is used
+        bool addFix(double latitude, double longitude, double sigma, MATCH *match);
+
+        //the most probable matches of fixes in the window, the oldest first
+        void getPath(std::vector<MATCH> *path);
+
+        void reset();
+
+        //count of fixes, which ran out of time budget
+        int getOverBudget() const;
+
+    private:
+
+        typedef struct candidate {
+            MATCH match;
+            double length;          //[m] of edge
+            double score;           //log probability of the best sequence ending here
+            int previous;           //index in previous layer, -1 - start of sequence
+        } CANDIDATE;
+
+        typedef struct layer {
+            Parser::OSM_NODE fix;
+            std::vector<CANDIDATE> candidates;
+            int best;
+        } LAYER;
+
+        //distances [cm] from source node within bound
+        typedef struct reach {
+            unsigned int bound;
+            boost::unordered_map<int, unsigned int> distances;
+        } REACH;
+
+        Parser *map;
+
+        double sigma;
+        double beta;
+        double search_radius;
+        int max_candidates;
+        int window_size;
+        double time_budget;
+
+        std::deque<LAYER> window;
+        boost::unordered_map<int, REACH> reach_cache;
+        unsigned long version;
+        int over_budget;
+
+        const static int MAX_CACHED_SOURCES = 1024;
+
+        void findCandidates(Parser::GRAPH *graph, Parser::OSM_NODE fix, double sigma, std::vector<CANDIDATE> *candidates);
+
+        //route distance [m] between projections, negative if it is longer than bound [m]
+        double getRouteDistance(const IntegerGraph &graph, const CANDIDATE &from, const CANDIDATE &to, double bound);
+        const REACH &getReach(const IntegerGraph &graph, int source, unsigned int bound);
+
+        static double getStraightDistance(const CANDIDATE &from, const CANDIDATE &to);
+        static bool compareByDistance(const CANDIDATE &a, const CANDIDATE &b);
+    };
+}
+
+#endif //OSM_MAP_MATCHER_H
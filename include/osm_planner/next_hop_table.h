@@ -0,0 +1,46 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_NEXT_HOP_TABLE_H
+#define OSM_NEXT_HOP_TABLE_H
+
+#include <osm_planner/graph_search.h>
+
+#include <boost/atomic.hpp>
+
+namespace osm_planner {
+
+    //Exact all-pairs table for tiny maps - for every pair of nodes the first move of shortest path and its length.
+    //Path is walk over the table, every step is one lookup. Memory is N^2 * (4 + 4) bytes.
+    class NextHopTable {
+    public:
+
+        NextHopTable();
+
+        //one search from every node, searches are divided between threads
+        void build(const IntegerGraph &graph, unsigned long version, int threads = 1);
+
+        //true only for the same version of graph
+        bool isReady(unsigned long version);
+
+        //empty if target is unreachable
+        std::vector<int> getPath(int source, int target);
+
+        //metres, Dijkstra::INFINITY_DISTANCE if target is unreachable
+        float getDistance(int source, int target);
+
+        long getMemory();
+
+    private:
+
+        int size;
+        unsigned long version;
+        std::vector<int> next_hop;              //[target * size + source] - next node from source to target, -1 unreachable
+        std::vector<unsigned int> distances;    //[target * size + source] - centimetres
+
+        void buildRows(const IntegerGraph *graph, boost::atomic<int> *next_target);
+    };
+}
+
+#endif //OSM_NEXT_HOP_TABLE_H
@@ -10,12 +10,18 @@
 #define OSM_LOCALIZATION_H
 
 #include <osm_planner/osm_parser.h>
+#include <osm_planner/tile_cache.h>
+#include <osm_planner/seqlock.h>
+#include <osm_planner/map_matcher.h>
 #include <tf/tf.h>
 #include <tf/transform_broadcaster.h>
-#include <tf/transform_listener.h>
+#include <tf2_ros/static_transform_broadcaster.h>
+#include <tf2_ros/buffer.h>
+#include <tf2_ros/transform_listener.h>
 
 #include <ros/ros.h>
 #include <boost/thread.hpp>
+#include <map>
 
 #include <nav_msgs/Odometry.h>
 #include <sensor_msgs/NavSatFix.h>
@@ -29,13 +35,27 @@ namespace osm_planner {
     class TfHandler{
 
     public:
+
+        //correction of local map frame in map frame
+        typedef struct tf_state{
+            double x;
+            double y;
+            double yaw;
+        }TF_STATE;
+
         TfHandler(osm_planner::Parser::Haversine *calculator);
+
+        //on change - transform is sent as static only after change and every keepalive_period [s] (0 - never),
+        //otherwise it is sent at 50 Hz
+        void setBroadcastMode(bool on_change, double keepalive_period);
         void initThread();
+        //tf buffer is filled by listener thread from now, lookups don't wait for it
+        void initListener();
         void setTfRotation(double angle);
         void improveTfPoseFromGPS(const sensor_msgs::NavSatFix::ConstPtr& gps);
         void improveTfRotation(double angle);
 
-        geometry_msgs::Point getPoseFromTF(std::string map_link); //from tf
+        geometry_msgs::Point getPoseFromTF(std::string map_link); //from tf, the last known pose if transform isn't available
 
         void setFrames(std::string map_frame, std::string local_map_frame, std::string base_link_frame);
         std::string getMapFrame();
@@ -50,23 +70,36 @@ namespace osm_planner {
 
         /*tf broadcaster*/
         tf::TransformBroadcaster br;
-        tf::Transform transform;
+        tf2_ros::StaticTransformBroadcaster static_br;
+        bool broadcast_on_change;
+        double keepalive_period;
+
+        //broadcaster reads it without lock, writers are serialized by writer_mutex
+        SeqLock<TF_STATE> tf_state;
+        boost::mutex writer_mutex;
+
+        geometry_msgs::TransformStamped createTransform(const TF_STATE &state, ros::Time stamp);
+
+        /*tf listener*/
+        boost::shared_ptr<tf2_ros::Buffer> tf_buffer;
+        boost::shared_ptr<tf2_ros::TransformListener> tf_listener;
+        std::map<std::string, geometry_msgs::Point> last_poses;     //the last pose in every map frame
+        boost::mutex listener_mutex;
+
+        //tf2 frames have no leading slash
+        static std::string getTf2Frame(std::string frame);
 
-        double yaw;
         //tf broadcaster thread
         //    double initial_angle;
         boost::shared_ptr<boost::thread> tfThread;
         void tfBroadcaster();
-
-
-        boost::mutex broadcaster_mutex;
     };
 
     class PathFollower{
 
     public:
         PathFollower(osm_planner::Parser *map, TfHandler *tf);
-        void addPoint(const sensor_msgs::NavSatFix::ConstPtr& gps);
+        void addPoint(const sensor_msgs::NavSatFix::ConstPtr& gps, int nodeID);    //node of map matched to the fix
         bool doCorrection();
         void setMaxDistance(double maxDistance);
         void setAngleRange(double *angle);
@@ -84,8 +117,10 @@ namespace osm_planner {
         //geometry_msgs::Point currentPosition;
 
         bool firstNodeAdded, secondNodeAdded;
+        int lastNodeID;
 
         double angleDiff;
+        double angleOnStart;
 
         double bearing;
         double maxDistance;
@@ -110,14 +145,26 @@ namespace osm_planner {
 
         Localization(osm_planner::Parser *map);
 
+        //params, topics and services in namespace ns instead of ~/Planner
+        Localization(osm_planner::Parser *map, std::string ns);
+
         POINT *getCurrentPosition();
         TfHandler *getTF();
 
+        //lock it while reading or updating current position from other threads than gps callback
+        boost::mutex *getPositionMutex();
+
         double getFootwayWidth();
         bool isInitialized();
 
 
         void initialize();
+
+        //gps callback and services are in the queue instead of the global one, it must be set before initialize()
+        void setCallbackQueue(ros::CallbackQueueInterface *queue);
+
+        //map is loaded by tiles around the position instead of parsing the whole file
+        void setTileCache(TileCache *tiles);
         //todo prerobit lokalizacne veci z osm_planner sem
 
         //Before start make plan, this function must be call
@@ -130,6 +177,8 @@ namespace osm_planner {
         void setPositionFromOdom(geometry_msgs::Point point);  //from odom
         bool updatePoseFromTF();
 
+        //distance out of the way minus footway width, from the distance field if the point is inside it,
+        //otherwise from the node
         double checkDistance(int node_id, double lat, double lon);
         double checkDistance(int node_id, geometry_msgs::Pose pose);
 
@@ -137,15 +186,24 @@ namespace osm_planner {
 
         TfHandler tfHandler;
         PathFollower pathFollower;
+        MapMatcher mapMatcher;
 
         osm_planner::Parser *map;
+        TileCache *tiles;
+        std::string ns;
+        ros::CallbackQueueInterface *callback_queue;
 
         POINT source;
+        boost::mutex position_mutex;
 
         bool initialized_ros;
         bool initialized_position;
         bool initFromGpsCallback;
 
+        double gps_last_cov;            //the best accuracy of gps, which corrected tf
+        bool tf_corrected;              //tf was aligned with path
+        Parser::OSM_NODE bearing_first_point;   //first point of compute_bearing service
+        bool bearing_first_point_added;
 
         //global ros parameters
         int matching_tf_with_map;
@@ -153,6 +211,17 @@ namespace osm_planner {
         double interpolation_max_distance;
         double footway_width;
 
+        //source node is tracked from the previous one, if the robot moved less than tracking_max_distance
+        double tracking_max_distance;
+        unsigned long tracking_version;     //version of graph with the previous source node
+        void trackSource(double lat, double lon);
+
+        //gps fixes are matched to the edges by hidden Markov model instead of snapping to the nearest node
+        bool use_map_matching;
+
+        //[m] to the nearest way from the distance field of map, negative if it isn't available
+        double getFieldDistance(double x, double y);
+
         static const int DISABLED = 0;
         static const int ENABLED_ONE = 1;
         static const int ENABLED_ALLWAYS = 2;
@@ -12,6 +12,19 @@
 //ros and tf
 #include <ros/ros.h>
 #include <tf/transform_datatypes.h>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <osm_planner/graph_search.h>
+#include <osm_planner/compact_store.h>
+#include <osm_planner/graph_segment.h>
+#include <osm_planner/executor.h>
 
 //messages
 #include <visualization_msgs/Marker.h>
@@ -20,6 +33,8 @@
 
 namespace osm_planner {
 
+    class DistanceField;
+
     class Parser {
     public:
 
@@ -38,41 +53,161 @@ namespace osm_planner {
         typedef struct osm_way {
             int id;
             std::vector<int> nodesId;
+            std::vector<int> refs;      //osm IDs of nodes in way, interpolation is computed from them
         } OSM_WAY;
 
+        //Every way of parsed map with interned tags. Filtered graphs are built from it without parsing of xml
+        //and all of them share it, the store isn't changed after parsing.
+        typedef struct way_store {
+            std::vector<int> node_ids;                      //osm IDs of nodes in crop region
+            NodeStore<OSM_NODE> nodes;                      //coordinates of nodes, the same index as node_ids
+            boost::unordered_map<int, int> node_index;      //osm ID -> index in nodes
+            std::vector<int> way_ids;                       //pieces of way clipped by crop region have the same ID
+            VarintArena way_refs;                           //osm IDs of nodes in ways, the same index as way_ids
+
+            //bit TAG_ANY - way has some tag, TAG_HIGHWAY - way has highway key,
+            //TAG_VALUES + i - way has highway = values[i]
+            std::vector<std::string> values;
+            int words;                                      //count of words in bitset of one way
+            std::vector<unsigned long long> tags;           //bitsets of ways, words * way_ids.size()
+        } WAY_STORE;
+
         typedef struct translate_table {
             int oldID;
             int newID;
         } TRANSLATE_TABLE;
 
+        //Snapshot of the parsed map. Parsing builds new snapshot and swaps it with the current one,
+        //searches, which are running on the old snapshot, keep it alive until they finish.
+        //Only deleting of edge and OsmChange update change snapshot in place, under its exclusive lock.
+        typedef struct graph {
+            std::vector<OSM_WAY> ways;
+            NodeStore<OSM_NODE> nodes;                  //fixed point coordinates, node is decoded by operator []
+            std::vector<std::vector<float> > networkArray;
+            IntegerGraph integer_graph;
+
+            //uniform lat/lon grid of nodes for nearest point queries
+            double grid_min_latitude, grid_min_longitude;
+            double grid_cell_size;      //[deg]
+            double grid_cell_metres;    //lower bound of cell width and height in metres
+            int grid_rows, grid_cols;
+            std::vector<std::vector<int> > grid;
+
+            //index for incremental updates by OsmChange files, coordinates of nodes are in the shared store,
+            //only changes of coordinates are in the graph
+            boost::shared_ptr<const WAY_STORE> store;                   //NULL for graph from tiles
+            boost::unordered_map<int, OSM_NODE> osm_nodes;              //coordinates of new and moved osm nodes by osm ID
+            boost::unordered_set<int> removed_osm_nodes;                //nodes of store, which were deleted
+            boost::unordered_map<int, int> node_index;                  //osm ID -> ID of node in graph
+            boost::unordered_map<int, std::vector<int> > node_ways;     //osm ID of node -> osm IDs of ways, which use it
+            boost::unordered_multimap<int, int> way_index;              //osm ID -> indexes of pieces in ways, way clipped by crop region can have more pieces
+            std::vector<int> free_nodes;                                //IDs of removed nodes for reuse
+
+            //mapped shared graph, nodes and integer_graph read its arrays, NULL for own graph
+            boost::shared_ptr<GraphSegment> segment;
+
+            boost::shared_mutex mutex;
+            boost::atomic<unsigned long> version;
+            boost::atomic<unsigned long> structure_version;     //the last version, which wasn't made by deleteEdgeOnGraph()
+        } GRAPH;
+
+        //Shared lock of the current snapshot. All getters called from this thread use the locked snapshot
+        //until the lock is released. Nested lock in the same thread does nothing.
+        class GraphLock {
+        public:
+
+            GraphLock(Parser *parser);
+            GraphLock(Parser *parser, boost::shared_ptr<GRAPH> graph);  //lock of the given snapshot, e.g. for worker threads
+            ~GraphLock();
+            void unlock();
+
+        private:
+
+            Parser *parser;
+            boost::shared_ptr<GRAPH> graph;
+            boost::shared_lock<boost::shared_mutex> lock;
+            bool pinned;
+
+            void pin(boost::shared_ptr<GRAPH> graph);
+
+            GraphLock(const GraphLock &);
+            GraphLock &operator=(const GraphLock &);
+        };
+
         const static int CURRENT_POSITION_MARKER = 0;
         const static int TARGET_POSITION_MARKER = 1;
 
+        //modes of shared graph
+        const static int SHARED_GRAPH_NONE = 0;
+        const static int SHARED_GRAPH_PUBLISH = 1;     //every new graph is written to shared memory
+        const static int SHARED_GRAPH_ATTACH = 2;      //parse() attaches the shared graph instead of reading of xml
+
         Parser(std::string xml);
 
         Parser();
 
-        //start parsing
+        //params and topics in namespace ns instead of ~/Planner, e.g. one of more planners in the process
+        Parser(std::string xml, std::string ns);
+
+        ~Parser();
+
+        //start parsing, the current snapshot serves other threads until the new one is ready
         void parse(bool onlyFirstElement = false);
 
+        //new snapshot for other filter of ways from the stored ways of the last parsing, xml isn't read again
+        //throws std::runtime_error if the map wasn't parsed yet
+        void filterWays(std::vector<std::string> types);
+
         //publishing functions
         void publishPoint(int pointID, int marker_type, double radius, geometry_msgs::Quaternion orientation = tf::createQuaternionMsgFromYaw(0));
         void publishPoint(geometry_msgs::Point point, int marker_type, double radius, geometry_msgs::Quaternion orientation = tf::createQuaternionMsgFromYaw(0));
         void publishPoint(double latitude, double longitude, int marker_type, double radius, geometry_msgs::Quaternion orientation = tf::createQuaternionMsgFromYaw(0));
 
+        //route network is slow to publish, with visualization queue it is published by its thread
         void publishRouteNetwork();
+        void setVisualizationQueue(ros::CallbackQueueInterface *queue);
 
         void publishRefusedPath(std::vector<int> nodesInPath);
 
         //deleting edge on the graph
         void deleteEdgeOnGraph(int nodeID_1, int nodeID_2);
 
+        //apply OsmChange diff (.osc) to the current graph, only touched ways are rebuilt
+        //returns count of changed ways, throws std::runtime_error if file can't be loaded
+        int applyChange(std::string osc);
+
+        //ways from tiles of compiled map, nodes contain coordinates of all refs of the ways
+        void addWays(const std::vector<OSM_WAY> &ways, const boost::unordered_map<int, OSM_NODE> &nodes);
+        void removeWays(const std::vector<int> &wayIDs);
+
+        //true if tag of way matches the filter of ways
+        static bool isSelectedWay(TiXmlElement *tag, std::vector<std::string> values);
+
         //GETTERS
-        std::vector<std::vector<float> > *getGraphOfVertex(); //for dijkstra algorithm
+        std::vector<std::vector<float> > *getGraphOfVertex(); //for dijkstra algorithm, GraphLock must be held
+        IntegerGraph *getIntegerGraph();                      //adjacency lists with centimetre weights, GraphLock must be held
+        boost::shared_ptr<GRAPH> getGraph();                  //locked snapshot of this thread or the current one
+        unsigned long getGraphVersion();                      //incremented by every change of the graph and new map
+        unsigned long getStructureVersion();                  //version of the last change other than deleted edge
         int getNearestPoint(double lat, double lon); //return OSM node ID
+        std::vector<int> getNearestPoints(const std::vector<OSM_NODE> &points); //snapping of more points in one query
         int getNearestPointXY(double point_x, double point_y); //return OSM node ID
+
+        //nearest node for tracking of robot - greedy walk on the graph from the previous node, usually few steps,
+        //then nodes of grid cells within the distance of the walk's result are checked, so the result is the same
+        //as of the global query, which is used if there is no previous node (-1) or the point is farther than max_distance [m] from it
+        int trackNearestPoint(int previous_id, double lat, double lon, double max_distance);
+        int trackNearestPointXY(int previous_id, double point_x, double point_y, double max_distance);
+
+        //all nodes within radius [m] from the point, e.g. candidates of map matching
+        std::vector<int> getPointsInRadius(double lat, double lon, double radius);
         OSM_NODE getNodeByID(int id);                //OSM NODE contains geogpraphics coordinates
+
+        //distances to ways in the map frame, NULL if the field is disabled or it wasn't built yet,
+        //after ways are changed the old field is returned until the new one is built in background
+        boost::shared_ptr<const DistanceField> getDistanceField();
         nav_msgs::Path getPath(std::vector<int> nodesInPath); //get the XY coordinates from vector of IDs
+        double getPathLength(const std::vector<int> &nodesInPath); //length of path in metres
 
         //SETTERS
         void setStartPoint(double latitude, double longitude, double bearing); //set the zero point in cartezian coordinates
@@ -82,6 +217,25 @@ namespace osm_planner {
 
         void setInterpolationMaxDistance(double param);
 
+        //raster of distances to edges, resolution and margin around nodes in metres, 0 resolution - disabled
+        void setDistanceField(double resolution, double margin, long max_cells);
+
+        //field of the current graph in the map frame, it must be called after the origin is set,
+        //later changes of ways rebuild it in background
+        void buildDistanceField();
+
+        //only nodes inside the region are parsed, ways are clipped at its boundary, radius in metres
+        void setCropBoundingBox(double min_latitude, double min_longitude, double max_latitude, double max_longitude);
+        void setCropRadius(double latitude, double longitude, double radius);
+        bool isInCropRegion(OSM_NODE node);
+
+        //graph in POSIX shared memory with the name, attached graph has no matrix and ways, only nodes and adjacency lists
+        void setSharedGraph(std::string name, int mode);
+        bool isSharedGraphAttached();
+
+        //attaches newer graph, if the publisher replaced the attached one, returns true if the graph was changed
+        bool updateSharedGraph();
+
 
 //#define WGS_84_FORMAT
         //Embedded class for calculating distance and bearing
@@ -265,6 +419,20 @@ namespace osm_planner {
 
             };
 
+            //inverse of getCoordinateX() and getCoordinateY() - destination point from origin by bearing and distance
+            OSM_NODE getGeoPoint(double x, double y){
+
+                double dist = sqrt(x * x + y * y) / R;
+                double bearing = atan2(x, y) - offset;
+                double lat1 = originPoint.latitude * DEG2RAD;
+
+                double lat2 = asin(sin(lat1) * cos(dist) + cos(lat1) * sin(dist) * cos(bearing));
+                double dLon = atan2(sin(bearing) * sin(dist) * cos(lat1), cos(dist) - sin(lat1) * sin(lat2));
+
+                OSM_NODE node = {lat2 * RAD2DEG, originPoint.longitude + dLon * RAD2DEG, 0, 0};
+                return node;
+            };
+
             template<class N1, class N2> static double getCoordinateY(N1 node1, N2 node2){
 
                 /*static double R = 6371e3;
@@ -310,6 +478,7 @@ namespace osm_planner {
 
         //map source
         std::string xml;
+        std::string ns;     //namespace of params and topics
 
         std::vector<std::string> types_of_ways;
 
@@ -318,6 +487,9 @@ namespace osm_planner {
         ros::Publisher target_marker_pub;
         ros::Publisher path_pub;
         ros::Publisher refused_path_pub;
+        ros::CallbackQueueInterface *visualization_queue;     //NULL - publishing in the calling thread
+
+        void publishPaths(std::vector<nav_msgs::Path> paths);
 
         //visualization msgs
         visualization_msgs::Marker position_marker, target_marker;
@@ -326,25 +498,115 @@ namespace osm_planner {
 
         int size_of_nodes;  //usage in function getNodesInWay(), counter of currently read nodes
 
+        //region of parsing
+        typedef struct crop_region {
+            int type;
+            double min_latitude, min_longitude, max_latitude, max_longitude;  //bounding box, also of the circle
+            OSM_NODE center;
+            double radius;      //[m]
+        } CROP_REGION;
+
+        const static int NO_CROP = 0;
+        const static int CROP_BOX = 1;
+        const static int CROP_RADIUS = 2;
+        CROP_REGION crop;
+
+        //parts of way between nodes out of region, nodes are known if they are inside, single nodes are dropped
+        static std::vector<std::vector<int> > clipRefs(const std::vector<int> &refs, const std::vector<bool> &known);
+
         //vector arrays of OSM nodes and ways
+        //buffers of parsing, they are moved to the new snapshot
         std::vector<OSM_WAY> ways;
-        std::vector<OSM_NODE> nodes;
+        NodeStore<OSM_NODE> nodes;
         std::vector<OSM_NODE_WITH_ID> interpolated_nodes;
         std::vector<TRANSLATE_TABLE> table;
-        std::vector<std::vector<float> > networkArray;
+        boost::unordered_map<int, int> translate_index;     //oldID -> newID of table
+        boost::shared_ptr<const WAY_STORE> store;           //of the last parsing, guarded by parse_mutex
+        boost::mutex parse_mutex;
+
+        //current snapshot, the pointer is guarded by graph_pointer_mutex
+        boost::shared_ptr<GRAPH> graph;
+        boost::mutex graph_pointer_mutex;
+        boost::thread_specific_ptr<boost::shared_ptr<GRAPH> > locked_graph;   //snapshot locked by GraphLock in this thread
+        boost::atomic<unsigned long> graph_version;
+
+        //shared graph, guarded by parse_mutex
+        std::string shared_graph_name;
+        int shared_graph_mode;
+
+        //distance field, the pointer and the flags are guarded by distance_field_mutex,
+        //only one field is built at a time, under distance_field_build_mutex
+        double distance_field_resolution;
+        double distance_field_margin;
+        long distance_field_max_cells;
+        boost::shared_ptr<const DistanceField> distance_field;
+        boost::mutex distance_field_mutex;
+        boost::mutex distance_field_build_mutex;
+        bool distance_field_building;
+        bool distance_field_outdated;      //ways were changed during the build, the field is built again
+        boost::shared_ptr<boost::thread> distance_field_thread;
+
+        constexpr static double GRID_CELL_SIZE = 0.0005;
+        const static int EDGE_SLACK = 2;    //free slots of every node in integer graph for updates
+        const static int MAX_TRACKING_STEPS = 64;   //longer walk of trackNearestPoint() is replaced by the global query
+
+        const static int TAG_ANY = 0;
+        const static int TAG_HIGHWAY = 1;
+        const static int TAG_VALUES = 2;
 
        void initialize();
 
         void createMarkers();
 
-        void createWays(TiXmlHandle *hRootWay, TiXmlHandle *hRootNode, std::vector<std::string> osm_value, bool onlyFirstElement = false);
-        bool isSelectedWay(TiXmlElement *tag, std::vector<std::string> values);
+        boost::shared_ptr<WAY_STORE> createStore(TiXmlHandle *hRootWay, TiXmlHandle *hRootNode);
+
+        //bits of filter, way is selected if it has some of them, the same rules as isSelectedWay()
+        static std::vector<unsigned long long> getTagMask(const WAY_STORE &store, std::vector<std::string> values);
+
+        //new snapshot from the store, parse_mutex must be held
+        boost::shared_ptr<GRAPH> createGraph(boost::shared_ptr<const WAY_STORE> store, std::vector<std::string> types, bool onlyFirstElement = false);
+
+        void createWays(const WAY_STORE &store, const std::vector<unsigned long long> &mask, bool onlyFirstElement = false);
+
+        void createNodes(const WAY_STORE &store, bool onlyFirstElement = false);
+
+        void createNetwork(GRAPH *graph);
+
+        void createGrid(GRAPH *graph);
+        int getNearestPoint(GRAPH *graph, OSM_NODE point);
+
+        //copy of nodes and compacted adjacency lists to new segment, parse_mutex must be held
+        void publishSharedGraph(GRAPH *graph);
+        //new snapshot on the current segment, false if it isn't ready, parse_mutex must be held
+        bool attachSharedGraph();
+
+        //ways were changed, built field is rebuilt in background, deleted edges don't change it
+        void updateDistanceField();
+        void buildDistanceFieldThread();
+        int getNearestPointInGrid(GRAPH *graph, OSM_NODE point);
+        int walkToNearestPoint(GRAPH *graph, int id, OSM_NODE point, double max_distance);    //-1 if the walk can't be used
+        void getPointsInGrid(GRAPH *graph, OSM_NODE point, double radius, std::vector<int> *ids);
 
-        void createNodes(TiXmlHandle *hRootNode, bool onlyFirstElement = false);
+        //incremental updates
+        void createIndex(GRAPH *graph);
+        bool isSelectedWay(TiXmlElement *wayElement);
+        void addWay(GRAPH *graph, OSM_WAY way);
+        void removeWay(GRAPH *graph, int wayID);       //all pieces of way
+        void removeWayPiece(GRAPH *graph, boost::unordered_multimap<int, int>::iterator index);
+        int addNode(GRAPH *graph, OSM_NODE node);
+        void removeNode(GRAPH *graph, int nodeID);
+        void setEdge(GRAPH *graph, int nodeID_1, int nodeID_2, double distance);
+        void removeEdge(GRAPH *graph, int nodeID_1, int nodeID_2);
+        void setGridCell(GRAPH *graph, int nodeID, bool add);
+        void updateGrid(GRAPH *graph);
 
-        void createNetwork();
+        //coordinates of osm node - changed ones from the graph, other from the store
+        bool findOsmNode(GRAPH *graph, int id, OSM_NODE *node);
+        void setOsmNode(GRAPH *graph, int id, OSM_NODE node);
+        void removeOsmNode(GRAPH *graph, int id);
+        bool grid_outdated;     //node out of grid was added, grid is rebuilt at the end of update
 
-        void getNodesInWay(TiXmlElement *wayElement, OSM_WAY *way, std::vector<OSM_NODE_WITH_ID> nodes);
+        void getNodesInWay(const std::vector<int> &refs, OSM_WAY *way, const WAY_STORE &store);
 
         bool translateID(int id, int *ret_value);
 
@@ -355,8 +617,8 @@ namespace osm_planner {
 
         double interpolation_max_distance;
 
-        //finding node by osm id in std::vector<OSM_NODE_WITH_ID> nodes buffer
-        OSM_NODE_WITH_ID getNodeByOsmId(std::vector<OSM_NODE_WITH_ID> nodes, int id);
+        //finding node by osm id in the store
+        OSM_NODE_WITH_ID getNodeByOsmId(const WAY_STORE &store, int id);
         //------------------------------------------
 
     };
@@ -1,9 +1,24 @@
 #include <ros/ros.h>
 #include <osm_planner/dijkstra.h>
+#include <osm_planner/workspace_pool.h>
+#include <osm_planner/route_cache.h>
+#include <osm_planner/landmarks.h>
+#include <osm_planner/hub_labels.h>
+#include <osm_planner/delta_stepping.h>
+#include <osm_planner/alternative_routes.h>
+#include <osm_planner/next_hop_table.h>
 #include <osm_planner/osm_parser.h>
+#include <osm_planner/tile_cache.h>
 #include <osm_planner/osm_localization.h>
 #include <osm_planner/newTarget.h>
 #include <osm_planner/cancelledPoint.h>
+#include <osm_planner/distanceMatrix.h>
+#include <osm_planner/routeCacheStats.h>
+#include <osm_planner/reachability.h>
+#include <osm_planner/viaPoints.h>
+#include <osm_planner/reloadMap.h>
+#include <osm_planner/applyMapChange.h>
+#include <osm_planner/setFilterOfWays.h>
 #include <std_msgs/Int32.h>
 #include <std_srvs/Empty.h>
 #include <std_srvs/SetBool.h>
@@ -37,8 +52,12 @@ namespace osm_planner {
         Planner();
         void initialize();
 
+        //one of more planners in the process, e.g. robot of fleet - params, topics and services are in ~/name
+        explicit Planner(std::string name);
+
         /** overriden classes from interface nav_core::BaseGlobalPlanner **/
         Planner(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
+        ~Planner();
         void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
         bool makePlan(const geometry_msgs::PoseStamped& start,
                       const geometry_msgs::PoseStamped& goal,
@@ -46,29 +65,166 @@ namespace osm_planner {
         );
 
         int makePlan(double target_latitude, double target_longitude);
+
+        //distances between all sources and targets, row-major matrix [source][target], -1 if target is unreachable
+        int makeDistanceMatrix(const std::vector<Parser::OSM_NODE> &sources, const std::vector<Parser::OSM_NODE> &targets,
+                               std::vector<double> *distances, std::vector<nav_msgs::Path> *paths = NULL);
+
+        //route through ordered waypoints, legs are planned in parallel, the route is published as current plan
+        int makeViaPlan(const std::vector<Parser::OSM_NODE> &waypoints, bool from_current_position,
+                        std::vector<double> *leg_distances, nav_msgs::Path *via_path);
+
+        //all nodes within max_distance [m] along the road network from the point, segments are edges between reachable nodes,
+        //coordinates of nodes are from the same snapshot as the search
+        int makeReachability(double latitude, double longitude, double max_distance, std::vector<int> *nodes,
+                             std::vector<double> *distances, std::vector<nav_msgs::Path> *segments = NULL,
+                             std::vector<Parser::OSM_NODE> *coordinates = NULL);
+
+        //parse map in background thread, plans are made on the old graph until the new one is swapped in
+        int reloadMap(std::string file, bool wait);
+
+        //apply OsmChange diff to the current graph, only touched ways are rebuilt
+        int applyMapChange(std::string file, int *changed_ways);
+
+        //new graph from the ways of parsed map, which match the filter, xml isn't read again
+        int setFilterOfWays(std::vector<std::string> types, int *ways);
         ros::NodeHandle n;
 
     protected:
 
+        //node with executor - services and timers of planner are in planning queue, gps and localization services
+        //in localization queue and route network is published in visualization queue
+        explicit Planner(Executor *executor);
+
         //Class for localization on the map
         Localization localization;
 
 
-        //make plan from source to target
-        int planning(int sourceID, int targetID);
+        //make plan from source to target on one of the workspaces or take it from route cache, thread safe
+        int planning(int sourceID, int targetID, std::vector<int> *nodes, nav_msgs::Path *path = NULL,
+                     std::vector<std::vector<int> > *alternatives = NULL);
 
         //deleted selected point id on the path
         int cancelPoint(int pointID);
 
+        //count of threads, which can plan at the same time
+        int planner_threads;
+
+        //one-to-all searches - Δ-stepping on reachability_threads threads with buckets of delta_stepping_bucket [m]
+        int reachability_threads;
+        double delta_stepping_bucket;
 
     private:
 
         Parser osm;
-        Dijkstra dijkstra;
+        TileCache tiles;
+        WorkspacePool workspaces;
+        RouteCache route_cache;
+        bool route_cache_paths;     //save also path msgs to route cache
 
         bool initialized_ros;
 
+        //flags and versions shared by all constructors, so none of them is left uninitialized
+        void initializeMembers();
+
+        //asynchronous planning with deadline - search runs in background thread and makePlan() waits max planning_deadline
+        bool async_planning;
+        double planning_deadline;
+        Dijkstra async_dijkstra;
+        boost::shared_ptr<boost::thread> async_thread;
+        boost::mutex async_mutex;
+        boost::condition_variable async_finished;
+        bool async_running;
+        int async_source, async_target;
+        unsigned long async_version;
+        int async_result;
+        std::vector<int> async_nodes;
+        std::vector<float> async_heuristic;
+
+        //start or reuse background search and wait for it, partial path is returned if the deadline is exceeded
+        int asyncPlanning(int sourceID, int targetID, std::vector<int> *nodes, bool *partial);
+        void asyncSearch(boost::shared_ptr<Parser::GRAPH> graph, int sourceID, int targetID);
+        void cancelAsyncSearch(boost::mutex::scoped_lock &lock);
+
+        //A* heuristic - max of geodesic distance and landmark lower bounds, shared lock of graph must be held
+        bool use_astar;
+        int landmarks_count;
+        std::string landmarks_file;
+        boost::shared_ptr<Landmarks> landmarks;
+        bool landmarks_building;
+        boost::shared_ptr<boost::thread> landmarks_thread;
+        boost::mutex landmarks_mutex;
+
+        //landmarks for current graph or NULL if they are not ready yet, they are built like hub labels
+        boost::shared_ptr<Landmarks> getLandmarks();
+        void buildLandmarks();
+        void getHeuristic(int targetID, std::vector<float> *heuristic);
+
+        //worker of makeViaPlan() - takes legs until all are planned
+        void planLegs(boost::shared_ptr<Parser::GRAPH> graph, const std::vector<int> *ids, std::vector<std::vector<int> > *leg_nodes, std::vector<int> *results, boost::atomic<int> *next);
+
+        //alternatives are computed with every route and cached with it, 0 - disabled
+        int alternative_routes;
+        double alternative_max_stretch;
+        double alternative_max_share;
+
+        //remaining part of alternative from source, whose edges are all in the current graph, plan_mutex must be held
+        bool useAlternative(int sourceID, std::vector<int> *nodes);
+
+        //kernel of the synchronous search
+        std::string search_kernel;
+
+        //hub labels for small maps - queries without graph search, rebuilt in background after every change of graph
+        bool use_hub_labels;
+        int hub_labels_max_nodes;
+        boost::shared_ptr<HubLabels> hub_labels;
+        bool hub_labels_building;
+        boost::shared_ptr<boost::thread> hub_labels_thread;
+        boost::mutex hub_labels_mutex;
+
+        //labels for current version of graph or NULL if they are not ready yet, shared lock of graph must be held
+        boost::shared_ptr<HubLabels> getHubLabels();
+        void buildHubLabels();
+
+        //exact all-pairs table for maps up to all_pairs_max_nodes nodes, rebuilt like hub labels, disabled with tiles and attached graph
+        int all_pairs_max_nodes;
+        boost::shared_ptr<NextHopTable> next_hop_table;
+        bool next_hop_table_building;
+        boost::shared_ptr<boost::thread> next_hop_table_thread;
+        boost::mutex next_hop_table_mutex;
+
+        boost::shared_ptr<NextHopTable> getNextHopTable();
+        void buildNextHopTable();
+
+        //hot reload of map, guarded by reload_mutex
+        std::string map_file;
+        bool reloading;
+        int reload_result;
+        boost::shared_ptr<boost::thread> reload_thread;
+        boost::mutex reload_mutex;
+
+        void reloadMapThread(std::string file);
+
+        //on-demand loading of compiled map, tiles of route corridor are loaded before snapping and planning
+        int tiles_corridor_radius;
+
+        //loads corridor between points and pins it, nothing if the map isn't tiled
+        void loadCorridor(const std::vector<Parser::OSM_NODE> &points);
+        void loadCorridor(const std::vector<int> &nodes);
+
+        //graph attached from shared memory is replaced by the new graph of the publisher
+        ros::Timer shared_graph_timer;
+        void sharedGraphCallback(const ros::TimerEvent &event);
+
+        //current position and target are snapped to the changed map, plan and landmarks are dropped
+        void resetPlan();
+
+        //current plan - target, shortest path as osm nodes IDs and path msgs, guarded by plan_mutex
+        boost::mutex plan_mutex;
         POINT target;
+        std::vector<int> solution;
+        std::vector<std::vector<int> > alternatives;    //precomputed alternatives of solution for cancelPoint()
+        unsigned long alternatives_version;             //of graph, which alternatives were planned on
 
       //  bool use_map_rotation;
         /*Publisher*/
@@ -81,10 +237,24 @@ namespace osm_planner {
         /* Services */
         ros::ServiceServer cancel_point_service;
         ros::ServiceServer drawing_route_service;
+        ros::ServiceServer distance_matrix_service;
+        ros::ServiceServer route_cache_stats_service;
+        ros::ServiceServer reachability_service;
+        ros::ServiceServer via_points_service;
+        ros::ServiceServer reload_map_service;
+        ros::ServiceServer apply_map_change_service;
+        ros::ServiceServer set_filter_of_ways_service;
 
         //callbacks
         bool cancelPointCallback(osm_planner::cancelledPoint::Request &req, osm_planner::cancelledPoint::Response &res);
         bool drawingRouteCallback(std_srvs::Empty::Request &req, std_srvs::Empty::Response &res);
+        bool distanceMatrixCallback(osm_planner::distanceMatrix::Request &req, osm_planner::distanceMatrix::Response &res);
+        bool routeCacheStatsCallback(osm_planner::routeCacheStats::Request &req, osm_planner::routeCacheStats::Response &res);
+        bool reachabilityCallback(osm_planner::reachability::Request &req, osm_planner::reachability::Response &res);
+        bool viaPointsCallback(osm_planner::viaPoints::Request &req, osm_planner::viaPoints::Response &res);
+        bool reloadMapCallback(osm_planner::reloadMap::Request &req, osm_planner::reloadMap::Response &res);
+        bool applyMapChangeCallback(osm_planner::applyMapChange::Request &req, osm_planner::applyMapChange::Response &res);
+        bool setFilterOfWaysCallback(osm_planner::setFilterOfWays::Request &req, osm_planner::setFilterOfWays::Response &res);
 
     };
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_ROUTE_CACHE_H
+#define OSM_ROUTE_CACHE_H
+
+#include <nav_msgs/Path.h>
+
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <list>
+
+namespace osm_planner {
+
+    //Bounded LRU cache of planned routes.
+    //Key is the pair of snapped osm nodes and version of the graph, so every change of the graph invalidates it.
+    class RouteCache {
+    public:
+
+        typedef struct route {
+            std::vector<int> nodes;     //shortest path as osm nodes IDs
+            bool hasPath;               //path msgs is saved only if it is enabled
+            nav_msgs::Path path;
+            std::vector<std::vector<int> > alternatives;  //other routes to the same target, if they are enabled
+        } ROUTE;
+
+        RouteCache(int max_entries = 0);
+
+        void setMaxEntries(int max_entries);
+        int getMaxEntries();
+
+        //returns false on miss
+        bool get(int sourceID, int targetID, unsigned long version, ROUTE *route);
+
+        //newer version clears the cache, route of older version than the last stored one is dropped
+        void put(int sourceID, int targetID, unsigned long version, const ROUTE &route);
+        void clear();
+
+        unsigned long getHits();
+        unsigned long getMisses();
+        int size();
+
+    private:
+
+        typedef struct key {
+            int sourceID;
+            int targetID;
+            unsigned long version;
+
+            bool operator==(const key &other) const {
+                return sourceID == other.sourceID && targetID == other.targetID && version == other.version;
+            }
+        } KEY;
+
+        struct KeyHash {
+            std::size_t operator()(const KEY &k) const {
+                std::size_t seed = 0;
+                boost::hash_combine(seed, k.sourceID);
+                boost::hash_combine(seed, k.targetID);
+                boost::hash_combine(seed, k.version);
+                return seed;
+            }
+        };
+
+        typedef std::list<std::pair<KEY, ROUTE> > ENTRIES;
+
+        int max_entries;
+        ENTRIES entries;            //the most recently used is first
+        boost::unordered_map<KEY, ENTRIES::iterator, KeyHash> index;
+        unsigned long last_version;
+
+        unsigned long hits;
+        unsigned long misses;
+
+        boost::mutex cache_mutex;
+    };
+}
+
+#endif //OSM_ROUTE_CACHE_H
@@ -0,0 +1,83 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_SEQLOCK_H
+#define OSM_SEQLOCK_H
+
+#include <boost/atomic.hpp>
+#include <cstring>
+#include <cstddef>
+
+namespace osm_planner {
+
+    //Small value for one writer and more readers without locks. Sequence is odd while the writer writes,
+    //reader copies the value and tries again, if the sequence was odd or it was changed during the copy.
+    //T must be trivially copyable, it is stored in atomic words, so the reader never waits for the writer.
+    template<class T>
+    class SeqLock {
+    public:
+
+        SeqLock() : sequence(0) {
+            store(T());
+        }
+
+        explicit SeqLock(const T &value) : sequence(0) {
+            store(value);
+        }
+
+        //only one thread can write at the same time
+        void store(const T &value) {
+
+            unsigned long long buffer[WORDS] = {};
+            memcpy(buffer, &value, sizeof(T));
+
+            unsigned long start = sequence.load(boost::memory_order_relaxed);
+            sequence.store(start + 1, boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_release);
+
+            for (int i = 0; i < WORDS; i++)
+                words[i].store(buffer[i], boost::memory_order_relaxed);
+
+            sequence.store(start + 2, boost::memory_order_release);
+        }
+
+        //version is changed by every store, so readers can find out, that value is new
+        T load(unsigned long *version = NULL) const {
+
+            unsigned long long buffer[WORDS];
+            unsigned long start, end;
+
+            do {
+                start = sequence.load(boost::memory_order_acquire);
+                for (int i = 0; i < WORDS; i++)
+                    buffer[i] = words[i].load(boost::memory_order_relaxed);
+                boost::atomic_thread_fence(boost::memory_order_acquire);
+                end = sequence.load(boost::memory_order_relaxed);
+            } while (start != end || (start & 1));
+
+            T value;
+            memcpy(&value, buffer, sizeof(T));
+            if (version)
+                *version = start;
+            return value;
+        }
+
+        unsigned long getVersion() const {
+
+            return sequence.load(boost::memory_order_acquire);
+        }
+
+    private:
+
+        static const int WORDS = (sizeof(T) + sizeof(unsigned long long) - 1) / sizeof(unsigned long long);
+
+        boost::atomic<unsigned long> sequence;
+        boost::atomic<unsigned long long> words[WORDS];
+
+        SeqLock(const SeqLock &);
+        SeqLock &operator=(const SeqLock &);
+    };
+}
+
+#endif //OSM_SEQLOCK_H
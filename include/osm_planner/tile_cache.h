@@ -0,0 +1,109 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_TILE_CACHE_H
+#define OSM_TILE_CACHE_H
+
+#include <osm_planner/osm_parser.h>
+
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <list>
+
+namespace osm_planner {
+
+    //On-demand loading of compiled map (map_tiler) - ways are split into tiles of global lat/lon grid.
+    //Only tiles around the robot and along the route corridor are kept in the graph, other tiles are evicted by LRU.
+    //Way, which crosses border of tiles, is in all of them and it is in the graph while at least one of them is loaded.
+    class TileCache {
+    public:
+
+        typedef std::pair<int, int> TILE_ID;    //row and column in grid of tiles
+
+        TileCache(Parser *map);
+        ~TileCache();
+
+        //reads index of tiles and starts prefetching thread, false if there is no index in directory
+        bool open(std::string directory, int max_tiles, int prefetch_radius);
+        bool isOpen();
+
+        //tiles within prefetch_radius around the robot are loaded in background and they aren't evicted
+        //wait - load them synchronously, e.g. before the first snapping
+        void setPosition(double latitude, double longitude, bool wait = false);
+
+        //synchronous loading of tiles crossed by polyline, widened by radius of tiles, they aren't evicted
+        //until the next corridor is set, returns count of newly loaded tiles
+        int loadCorridor(const std::vector<Parser::OSM_NODE> &points, int radius);
+
+        //synchronous loading of tiles within distance [m] around the point
+        int loadAround(double latitude, double longitude, double distance);
+
+        //center of some existing tile for initialization without position
+        Parser::OSM_NODE getFirstTileCenter();
+
+        //latency of synchronous loading
+        int getSyncLoads();
+        double getSyncLoadTime();       //[s] total
+        double getMaxSyncLoadTime();    //[s]
+
+        const static std::string INDEX_FILE;
+
+        //name of tile file in directory
+        static std::string getTileFile(std::string directory, TILE_ID tile);
+
+    private:
+
+        typedef struct loaded_tile {
+            std::list<TILE_ID>::iterator lru;
+            std::vector<int> ways;      //osm IDs of ways in tile
+        } LOADED_TILE;
+
+        Parser *map;
+        std::string directory;
+        double tile_size;               //[deg]
+        int max_tiles;
+        int prefetch_radius;
+        bool opened;
+
+        boost::unordered_set<TILE_ID> available;    //tiles, which exist in compiled map
+
+        //loaded tiles, guarded by cache_mutex
+        std::list<TILE_ID> lru;                     //the most recently used first
+        boost::unordered_map<TILE_ID, LOADED_TILE> loaded;
+        boost::unordered_map<int, int> way_users;   //count of loaded tiles with the way
+        boost::unordered_set<TILE_ID> position_tiles;
+        boost::unordered_set<TILE_ID> corridor_tiles;
+        boost::mutex cache_mutex;
+
+        //statistics, guarded by cache_mutex
+        int sync_loads;
+        double sync_load_time;
+        double max_sync_load_time;
+
+        //prefetching thread waits for new position
+        boost::shared_ptr<boost::thread> prefetch_thread;
+        boost::mutex prefetch_mutex;
+        boost::condition_variable prefetch_wakeup;
+        bool running;
+        bool new_position;
+        bool has_position;
+        TILE_ID position;
+
+        TILE_ID getTile(double latitude, double longitude);
+        void getTilesAround(TILE_ID center, int radius, boost::unordered_set<TILE_ID> *tiles);
+
+        //loads missing tiles, returns count of newly loaded ones
+        int load(const boost::unordered_set<TILE_ID> &tiles);
+        int loadSync(const boost::unordered_set<TILE_ID> &tiles);
+        bool load(TILE_ID tile);
+        void evict();
+
+        static bool readTile(std::string file, std::vector<Parser::OSM_WAY> *ways, boost::unordered_map<int, Parser::OSM_NODE> *nodes);
+
+        void prefetchThread();
+    };
+}
+
+#endif //OSM_TILE_CACHE_H
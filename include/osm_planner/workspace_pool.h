@@ -0,0 +1,69 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_WORKSPACE_POOL_H
+#define OSM_WORKSPACE_POOL_H
+
+#include <osm_planner/dijkstra.h>
+#include <osm_planner/graph_search.h>
+
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace osm_planner {
+
+    //Arrays of one running search - Dijkstra on the matrix and searches on integer adjacency lists
+    typedef struct search_workspace {
+        Dijkstra dijkstra;
+        RadixHeapSearch radix_heap_search;
+        BucketSearch bucket_search;
+    } SEARCH_WORKSPACE;
+
+    //Fixed count of search workspaces, which are shared by planning threads.
+    //Every running search owns one workspace, the graph itself is shared read-only.
+    //GraphLock is always taken before the workspace, so threads can't wait for each other in opposite order.
+    class WorkspacePool {
+    public:
+
+        WorkspacePool(int size = 1);
+
+        void resize(int size);
+        int size();
+
+        //blocks until some workspace is free
+        SEARCH_WORKSPACE *acquire();
+        void release(SEARCH_WORKSPACE *workspace);
+
+    private:
+
+        std::vector<boost::shared_ptr<SEARCH_WORKSPACE> > workspaces;
+        std::vector<SEARCH_WORKSPACE *> free_workspaces;
+
+        boost::mutex pool_mutex;
+        boost::condition_variable workspace_released;
+    };
+
+    //Workspace borrowed from the pool for the lifetime of the object
+    class Workspace {
+    public:
+
+        Workspace(WorkspacePool *pool) : pool(pool), workspace(pool->acquire()) {}
+        ~Workspace() { pool->release(workspace); }
+
+        Dijkstra *operator->() { return &workspace->dijkstra; }
+        Dijkstra *get() { return &workspace->dijkstra; }
+        RadixHeapSearch *getRadixHeapSearch() { return &workspace->radix_heap_search; }
+        BucketSearch *getBucketSearch() { return &workspace->bucket_search; }
+
+    private:
+
+        WorkspacePool *pool;
+        SEARCH_WORKSPACE *workspace;
+
+        Workspace(const Workspace &);
+        Workspace &operator=(const Workspace &);
+    };
+}
+
+#endif //OSM_WORKSPACE_POOL_H
@@ -0,0 +1,151 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/alternative_routes.h>
+
+#include <boost/unordered_set.hpp>
+
+namespace osm_planner {
+
+    AlternativeRoutes::AlternativeRoutes(int max_routes, double max_stretch, double max_share)
+            : max_routes(max_routes), max_stretch(max_stretch), max_share(max_share) {
+    }
+
+    std::vector<std::vector<int> > AlternativeRoutes::findRoutes(const IntegerGraph &graph, int src, int target) {
+
+        forward.findDistances(graph, src);
+        backward.findDistances(graph, target);
+
+        const std::vector<unsigned int> &df = forward.getDistances();
+        const std::vector<unsigned int> &db = backward.getDistances();
+        const std::vector<int> &pf = forward.getParents();
+        const std::vector<int> &pb = backward.getParents();
+
+        if (df[target] == IntegerGraph::INFINITY_WEIGHT)
+            throw dijkstra_exception(dijkstra_exception::NO_PATH_FOUND);
+
+        int size = graph.size();
+        unsigned int shortest = df[target];
+
+        //edge u -> v is on plateau, if it is in both trees
+        std::vector<int> next(size, -1);
+        for (int v = 0; v < size; v++) {
+            int u = pf[v];
+            if (u != -1 && pb[u] == v)
+                next[u] = v;
+        }
+
+        //plateaus are the longest chains of such edges
+        std::vector<PLATEAU> plateaus;
+        for (int a = 0; a < size; a++) {
+
+            if (next[a] == -1 || (pf[a] != -1 && next[pf[a]] == a))
+                continue;
+
+            if (df[a] == IntegerGraph::INFINITY_WEIGHT || db[a] == IntegerGraph::INFINITY_WEIGHT)
+                continue;
+
+            PLATEAU plateau;
+            plateau.start = a;
+            plateau.end = a;
+            while (next[plateau.end] != -1)
+                plateau.end = next[plateau.end];
+
+            plateau.length = df[plateau.end] - df[a];
+            plateau.route_length = df[a] + db[a];
+
+            if (plateau.route_length <= max_stretch * shortest)
+                plateaus.push_back(plateau);
+        }
+
+        std::sort(plateaus.begin(), plateaus.end(), compareByLength);
+
+        //shortest path is the first route
+        std::vector<std::vector<int> > routes;
+        std::vector<int> shortest_path;
+        for (int v = target; v != -1; v = pf[v]) {
+            shortest_path.push_back(v);
+        }
+        std::reverse(shortest_path.begin(), shortest_path.end());
+        routes.push_back(shortest_path);
+
+        for (int i = 0; i < plateaus.size() && routes.size() <= max_routes; i++) {
+
+            std::vector<int> route = getRoute(plateaus[i]);
+            if (!isSimple(route, size))
+                continue;
+
+            unsigned int length = getLength(graph, route);
+            bool different = true;
+            for (int j = 0; j < routes.size() && different; j++) {
+                different = getSharedLength(graph, route, routes[j]) <= max_share * length;
+            }
+
+            if (different)
+                routes.push_back(route);
+        }
+
+        return routes;
+    }
+
+    //source -> plateau start by source tree, then target tree continues over the plateau to the target
+    std::vector<int> AlternativeRoutes::getRoute(const PLATEAU &plateau) {
+
+        const std::vector<int> &pf = forward.getParents();
+        const std::vector<int> &pb = backward.getParents();
+
+        std::vector<int> route;
+        for (int v = plateau.start; v != -1; v = pf[v]) {
+            route.push_back(v);
+        }
+        std::reverse(route.begin(), route.end());
+
+        for (int v = pb[plateau.start]; v != -1; v = pb[v]) {
+            route.push_back(v);
+        }
+        return route;
+    }
+
+    //both trees can go through the same node
+    bool AlternativeRoutes::isSimple(const std::vector<int> &route, int size) {
+
+        std::vector<bool> visited(size, false);
+        for (int i = 0; i < route.size(); i++) {
+            if (visited[route[i]])
+                return false;
+            visited[route[i]] = true;
+        }
+        return true;
+    }
+
+    unsigned int AlternativeRoutes::getSharedLength(const IntegerGraph &graph, const std::vector<int> &route, const std::vector<int> &other) {
+
+        //undirected edges as pairs of nodes, smaller ID first
+        boost::unordered_set<std::pair<int, int> > edges;
+        for (int i = 1; i < other.size(); i++) {
+            edges.insert(std::make_pair(std::min(other[i - 1], other[i]), std::max(other[i - 1], other[i])));
+        }
+
+        unsigned int shared = 0;
+        for (int i = 1; i < route.size(); i++) {
+            if (edges.count(std::make_pair(std::min(route[i - 1], route[i]), std::max(route[i - 1], route[i]))))
+                shared += graph.getWeight(route[i - 1], route[i]);
+        }
+        return shared;
+    }
+
+    unsigned int AlternativeRoutes::getLength(const IntegerGraph &graph, const std::vector<int> &route) {
+
+        unsigned int length = 0;
+        for (int i = 1; i < route.size(); i++) {
+            length += graph.getWeight(route[i - 1], route[i]);
+        }
+        return length;
+    }
+
+    //the longest plateaus first
+    bool AlternativeRoutes::compareByLength(const PLATEAU &a, const PLATEAU &b) {
+
+        return a.length > b.length;
+    }
+}
@@ -0,0 +1,77 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/compact_store.h>
+
+namespace osm_planner {
+
+    int VarintArena::append(const std::vector<int> &list) {
+
+        offsets.push_back(bytes.size());
+        writeVarint(list.size());
+
+        long long previous = 0;
+        for (int i = 0; i < list.size(); i++) {
+            writeVarint(list[i] - previous);
+            previous = list[i];
+        }
+        return offsets.size() - 1;
+    }
+
+    void VarintArena::get(int index, std::vector<int> *list) const {
+
+        size_t position = offsets[index];
+        int count = readVarint(&position);
+
+        list->resize(count);
+        long long value = 0;
+        for (int i = 0; i < count; i++) {
+            value += readVarint(&position);
+            (*list)[i] = value;
+        }
+    }
+
+    int VarintArena::size() const {
+
+        return offsets.size();
+    }
+
+    void VarintArena::clear() {
+
+        bytes.clear();
+        offsets.clear();
+    }
+
+    size_t VarintArena::getMemory() const {
+
+        return bytes.capacity() + offsets.capacity() * sizeof(unsigned int);
+    }
+
+    /*--------------------PRIVATE FUNCTIONS---------------------*/
+
+    //zigzag - small negative differences are small numbers too, 7 bits in every byte
+    void VarintArena::writeVarint(long long value) {
+
+        unsigned long long zigzag = ((unsigned long long) value << 1) ^ (value >> 63);
+        while (zigzag >= 0x80) {
+            bytes.push_back((unsigned char) (zigzag | 0x80));
+            zigzag >>= 7;
+        }
+        bytes.push_back((unsigned char) zigzag);
+    }
+
+    long long VarintArena::readVarint(size_t *position) const {
+
+        unsigned long long zigzag = 0;
+        int shift = 0;
+        unsigned char byte;
+
+        do {
+            byte = bytes[(*position)++];
+            zigzag |= (unsigned long long) (byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        return (long long) (zigzag >> 1) ^ -(long long) (zigzag & 1);
+    }
+}
@@ -0,0 +1,166 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/delta_stepping.h>
+
+namespace osm_planner {
+
+    DeltaStepping::DeltaStepping(int threads, unsigned int delta) : graph(NULL), max_distance(0), light_phase(true), finished(false) {
+
+        this->threads = threads < 1 ? 1 : threads;
+        this->delta = delta < 1 ? 1 : delta;
+    }
+
+    void DeltaStepping::findDistances(const IntegerGraph &graph, int src, unsigned int max_distance) {
+
+        int size = graph.size();
+        this->graph = &graph;
+        this->max_distance = max_distance;
+
+        distance.assign(size, IntegerGraph::INFINITY_WEIGHT);
+        parent.assign(size, -1);
+        stamp.assign(size, -1);
+        buckets.assign(1, std::vector<int>());
+        requests.assign(threads, std::vector<REQUEST>());
+
+        distance[src] = 0;
+        buckets[0].push_back(src);
+
+        //workers wait on the barrier for every phase
+        finished = false;
+        boost::thread_group workers;
+        if (threads > 1) {
+            barrier = boost::shared_ptr<boost::barrier>(new boost::barrier(threads));
+            for (int i = 1; i < threads; i++) {
+                workers.create_thread(boost::bind(&DeltaStepping::worker, this, i));
+            }
+        }
+
+        int phase = 0;
+        std::vector<int> current;
+        std::vector<int> settled;
+
+        for (int i = 0; i < buckets.size(); i++) {
+
+            settled.clear();
+
+            //light edges can put nodes back to the same bucket
+            while (!buckets[i].empty()) {
+
+                current.swap(buckets[i]);
+                buckets[i].clear();
+
+                phase++;
+                frontier.clear();
+                for (int j = 0; j < current.size(); j++) {
+                    int v = current[j];
+                    if (distance[v] / this->delta == i && stamp[v] != phase) {
+                        stamp[v] = phase;
+                        frontier.push_back(v);
+                    }
+                }
+                settled.insert(settled.end(), frontier.begin(), frontier.end());
+
+                light_phase = true;
+                runPhase();
+            }
+
+            //distances in bucket are final, heavy edges go only to next buckets
+            std::sort(settled.begin(), settled.end());
+            settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+            frontier.swap(settled);
+
+            light_phase = false;
+            runPhase();
+        }
+
+        if (threads > 1) {
+            finished = true;
+            barrier->wait();
+            workers.join_all();
+        }
+    }
+
+    const std::vector<unsigned int> &DeltaStepping::getDistances() {
+
+        return distance;
+    }
+
+    const std::vector<int> &DeltaStepping::getParents() {
+
+        return parent;
+    }
+
+    void DeltaStepping::worker(int id) {
+
+        while (true) {
+
+            barrier->wait();
+            if (finished)
+                return;
+
+            collectRequests(id, threads);
+            barrier->wait();
+        }
+    }
+
+    void DeltaStepping::runPhase() {
+
+        if (threads == 1 || frontier.size() < PARALLEL_FRONTIER) {
+            collectRequests(0, 1);
+            relaxRequests(1);
+            return;
+        }
+
+        barrier->wait();
+        collectRequests(0, threads);
+        barrier->wait();
+        relaxRequests(threads);
+    }
+
+    //distances are only read while requests are collected
+    void DeltaStepping::collectRequests(int id, int parts) {
+
+        std::vector<REQUEST> &out = requests[id];
+        out.clear();
+
+        for (int i = id; i < frontier.size(); i += parts) {
+
+            int u = frontier[i];
+            for (int e = graph->begin(u); e < graph->end(u); e++) {
+
+                unsigned int weight = graph->weight(e);
+                if (weight == IntegerGraph::INFINITY_WEIGHT || (weight <= delta) != light_phase)
+                    continue;
+
+                REQUEST request;
+                request.node = graph->target(e);
+                request.parent = u;
+                request.distance = distance[u] + weight;
+
+                if (request.distance <= max_distance && request.distance < distance[request.node])
+                    out.push_back(request);
+            }
+        }
+    }
+
+    void DeltaStepping::relaxRequests(int parts) {
+
+        for (int t = 0; t < parts; t++) {
+            for (int i = 0; i < requests[t].size(); i++) {
+
+                const REQUEST &request = requests[t][i];
+                if (request.distance >= distance[request.node])
+                    continue;
+
+                distance[request.node] = request.distance;
+                parent[request.node] = request.parent;
+
+                int bucket = request.distance / delta;
+                if (bucket >= buckets.size())
+                    buckets.resize(bucket + 1);
+                buckets[bucket].push_back(request.node);
+            }
+        }
+    }
+}
@@ -10,73 +10,94 @@
 namespace osm_planner {
 
 
-    Dijkstra::Dijkstra() {
+    Dijkstra::Dijkstra() : cancelled(false), best_node(-1) {
     }
 
-    std::vector<int> Dijkstra::findShortestPath(std::vector<std::vector<float> > *graph, int src, int target) {
+    std::vector<int> Dijkstra::findShortestPath(std::vector<std::vector<float> > *graph, int src, int target, const std::vector<float> *heuristic) {
 
         //graph - matrix representation of the graph
-        std::vector<int> parent((*graph).size());     // Parent array to store shortest path tree
-        std::vector<float> dist((*graph).size());    // The output array. dist[i] will hold
-        // the shortest distance from src to i
+        int size = (*graph).size();
 
-        this->source = src;
         // sptSet[i] will true if vertex i is included / in shortest
         // path tree or shortest distance from src to i is finalized
-        bool sptSet[(*graph).size()];
-
-        // Initialize all distances as INFINITE and stpSet[] as false
-        for (int i = 0; i < (*graph).size(); i++) {
-            //parent[0] = -1;
-            parent[i] = -1;
-            dist[i] = 1000.0; //INT_MAX
-            sptSet[i] = false;
+        std::vector<bool> sptSet(size, false);
+
+        // Initialize all distances as INFINITE, arrays are kept in the object
+        // and the shortest path tree can be read by getPartialSolution() during the search
+        {
+            boost::mutex::scoped_lock lock(progress_mutex);
+            this->source = src;
+            parent.assign(size, -1);        // Parent array to store shortest path tree
+            distance.assign(size, INFINITY_DISTANCE);   // distance[i] will hold the shortest distance from src to i
+            best_node = -1;
         }
+        float best_goal_distance = INFINITY_DISTANCE;
 
         // Distance of source vertex from itself is always 0
-        dist[src] = 0;
+        distance[src] = 0;
 
         // Find shortest path for all vertices
-        for (int count = 0; count < (*graph).size() - 1; count++) {
+        for (int count = 0; count < size; count++) {
+
+            if (cancelled)
+                throw dijkstra_exception(dijkstra_exception::SEARCH_CANCELLED);
+
             // Pick the minimum distance vertex from the set of
             // vertices not yet processed. u is always equal to src
-            // in first iteration.
-            int u = minDistance(dist, sptSet);
+            // in first iteration. With heuristic it is vertex with minimum estimated length of path
+            int u = minDistance(distance, sptSet, heuristic);
+
+            // Rest of vertices is unreachable
+            if (u == -1)
+                break;
 
             // Mark the picked vertex as processed
             sptSet[u] = true;
 
+            // Remember processed vertex nearest to the goal, the path to it is the best partial solution
+            if (!goal_distance.empty() && goal_distance[u] < best_goal_distance) {
+                best_goal_distance = goal_distance[u];
+                best_node = u;
+            }
+
+            if (u == target) break;
+
             // Update dist value of the adjacent vertices of the
             // picked vertex.
-            for (int v = 0; v < (*graph).size(); v++)
+            const std::vector<float> &edges = (*graph)[u];
+            for (int v = 0; v < size; v++)
 
                 // Update dist[v] only if is not in sptSet, there is
                 // an edge from u to v, and total weight of path from
                 // src to v through u is smaller than current value of
                 // dist[v]
-                if (!sptSet[v] && (*graph)[u][v] &&
-                    dist[u] + (*graph)[u][v] < dist[v]) {
+                if (!sptSet[v] && edges[v] &&
+                    distance[u] + edges[v] < distance[v]) {
                     parent[v] = u;
-                    dist[v] = dist[u] + (*graph)[u][v];
-
+                    distance[v] = distance[u] + edges[v];
                 }
-
-            // print the constructed distance array
-                if (u == target) return getSolution(parent, dist, target);
-
         }
 
         // print the constructed distance array
-        return getSolution(parent, dist, target);
+        return getSolution(target);
     }
 
 
-    int Dijkstra::minDistance(std::vector<float> dist, bool sptSet[]) {
+    int Dijkstra::minDistance(const std::vector<float> &dist, const std::vector<bool> &sptSet, const std::vector<float> *heuristic) {
         // Initialize min value
-        int min = 1000.0, min_index; //INT_MAX
+        float min = INFINITY_DISTANCE;
+        int min_index = -1;
+
+        if (heuristic) {
+            for (int v = 0; v < dist.size(); v++)
+                if (sptSet[v] == false && dist[v] != INFINITY_DISTANCE && dist[v] + (*heuristic)[v] < min)
+                    min = dist[v] + (*heuristic)[v], min_index = v;
+
+            return min_index;
+        }
 
         for (int v = 0; v < dist.size(); v++)
-            if (sptSet[v] == false && dist[v] <= min)
+            if (sptSet[v] == false && dist[v] < min)
                 min = dist[v], min_index = v;
 
         return min_index;
@@ -84,12 +105,12 @@ namespace osm_planner {
 
 // Function to print shortest path from source to j
 // using parent array
-    void Dijkstra::printPath(std::vector<int> parent, int j) {
+    void Dijkstra::printPath(int j) {
         // Base Case : If j is source
         if (parent[j] == -1)
             return;
 
-        printPath(parent, parent[j]);
+        printPath(parent[j]);
 
         path.push_back(j);
     }
@@ -97,17 +118,16 @@ namespace osm_planner {
 // A utility function to print the constructed distance
 // array
 
-    std::vector<int> Dijkstra::getSolution(std::vector<int> parent, std::vector<float> dist, int target) {
+    std::vector<int> Dijkstra::getSolution(int target) {
 
         path.clear();
 
-
-        if (dist[target] >= 1000.0) {
+        if (distance[target] == INFINITY_DISTANCE) {
             throw dijkstra_exception(dijkstra_exception::NO_PATH_FOUND);
         }
         path.push_back(source);
 
-        printPath(parent, target);
+        printPath(target);
 
         return path;
     }
@@ -116,4 +136,109 @@ namespace osm_planner {
 
         return path;
     }
+
+    void Dijkstra::setGoalDistance(const std::vector<float> &goal_distance) {
+
+        this->goal_distance = goal_distance;
+    }
+
+    void Dijkstra::setCancelled(bool cancelled) {
+
+        this->cancelled = cancelled;
+    }
+
+// Can be called from other thread while findShortestPath() is running.
+// Parents of processed vertices are final, so the path can be read without stopping the search.
+    std::vector<int> Dijkstra::getPartialSolution() {
+
+        boost::mutex::scoped_lock lock(progress_mutex);
+
+        std::vector<int> nodes;
+        int node = best_node;
+        if (node == -1)
+            return nodes;
+
+        for (int v = node; v != -1; v = parent[v]) {
+            nodes.push_back(v);
+        }
+        std::reverse(nodes.begin(), nodes.end());
+        return nodes;
+    }
+
+    constexpr float Dijkstra::INFINITY_DISTANCE;
+
+// One-to-many variant - the search is shared by all targets and stops when the last of them is settled
+    std::vector<float> Dijkstra::findDistances(std::vector<std::vector<float> > *graph, int src, const std::vector<int> &targets) {
+
+        int size = (*graph).size();
+        {
+            boost::mutex::scoped_lock lock(progress_mutex);
+            this->source = src;
+            parent.assign(size, -1);
+            distance.assign(size, INFINITY_DISTANCE);
+            best_node = -1;
+        }
+        std::vector<bool> sptSet(size, false);
+
+        //count of different targets, which are not settled yet
+        std::vector<bool> isTarget(size, false);
+        int remaining = 0;
+        for (int i = 0; i < targets.size(); i++) {
+            if (!isTarget[targets[i]]) {
+                isTarget[targets[i]] = true;
+                remaining++;
+            }
+        }
+
+        distance[src] = 0;
+
+        while (remaining > 0) {
+
+            //pick the nearest not processed vertex
+            int u = -1;
+            float min = INFINITY_DISTANCE;
+            for (int v = 0; v < size; v++) {
+                if (!sptSet[v] && distance[v] < min) {
+                    min = distance[v];
+                    u = v;
+                }
+            }
+
+            //all other vertices are unreachable
+            if (u == -1)
+                break;
+
+            sptSet[u] = true;
+            if (isTarget[u])
+                remaining--;
+
+            const std::vector<float> &edges = (*graph)[u];
+            for (int v = 0; v < size; v++) {
+                if (!sptSet[v] && edges[v] && distance[u] + edges[v] < distance[v]) {
+                    parent[v] = u;
+                    distance[v] = distance[u] + edges[v];
+                }
+            }
+        }
+
+        std::vector<float> result(targets.size());
+        for (int i = 0; i < targets.size(); i++) {
+            result[i] = distance[targets[i]];
+        }
+        return result;
+    }
+
+    std::vector<int> Dijkstra::getPathTo(int target) {
+
+        std::vector<int> nodes;
+
+        if (target < 0 || target >= distance.size() || distance[target] == INFINITY_DISTANCE)
+            return nodes;
+
+        for (int v = target; v != -1; v = parent[v]) {
+            nodes.push_back(v);
+        }
+        std::reverse(nodes.begin(), nodes.end());
+        return nodes;
+    }
 }
\ No newline at end of file
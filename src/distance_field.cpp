@@ -0,0 +1,216 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/distance_field.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace osm_planner {
+
+    DistanceField::DistanceField() : min_x(0), min_y(0), resolution(1), rows(0), cols(0), version(0) {
+    }
+
+    void DistanceField::build(Parser::GRAPH *graph, Parser::Haversine *calculator, double resolution, double margin, long max_cells) {
+
+        const IntegerGraph &integer_graph = graph->integer_graph;
+        version = graph->version;
+
+        //nodes in the map frame
+        std::vector<double> xs(integer_graph.size()), ys(integer_graph.size());
+        for (int i = 0; i < integer_graph.size(); i++) {
+            xs[i] = calculator->getCoordinateX(graph->nodes[i]);
+            ys[i] = calculator->getCoordinateY(graph->nodes[i]);
+        }
+
+        //segments of ways, edges deleted by refused paths are still on the way, so the field isn't changed by them,
+        //attached shared graph has no ways, every edge is taken once regardless of its weight
+        segments.clear();
+        if (!graph->ways.empty()) {
+            for (int i = 0; i < graph->ways.size(); i++) {
+                const std::vector<int> &nodesId = graph->ways[i].nodesId;
+                for (int j = 1; j < nodesId.size(); j++) {
+                    addSegment(nodesId[j - 1], nodesId[j], xs, ys);
+                }
+            }
+        } else {
+            for (int u = 0; u < integer_graph.size(); u++) {
+                for (int e = integer_graph.begin(u); e < integer_graph.end(u); e++) {
+                    if (u < integer_graph.target(e))
+                        addSegment(u, integer_graph.target(e), xs, ys);
+                }
+            }
+        }
+
+        double max_x = -std::numeric_limits<double>::infinity(), max_y = max_x;
+        min_x = std::numeric_limits<double>::infinity();
+        min_y = min_x;
+        for (int s = 0; s < segments.size(); s++) {
+            min_x = std::min(min_x, std::min(segments[s].ax, segments[s].bx));
+            min_y = std::min(min_y, std::min(segments[s].ay, segments[s].by));
+            max_x = std::max(max_x, std::max(segments[s].ax, segments[s].bx));
+            max_y = std::max(max_y, std::max(segments[s].ay, segments[s].by));
+        }
+
+        if (segments.empty()) {
+            rows = cols = 0;
+            distances.clear();
+            nearest.clear();
+            return;
+        }
+
+        min_x -= margin;
+        min_y -= margin;
+        double width = max_x + margin - min_x;
+        double height = max_y + margin - min_y;
+
+        double cells = (floor(width / resolution) + 1) * (floor(height / resolution) + 1);
+        if (max_cells > 0 && cells > max_cells) {
+            double coarse = resolution * sqrt(cells / max_cells) * 1.01;
+            ROS_WARN("OSM planner: Distance field would have %.0f cells, resolution %.2f m is used instead of %.2f m",
+                     cells, coarse, resolution);
+            resolution = coarse;
+        }
+        this->resolution = resolution;
+        cols = (int) floor(width / resolution) + 1;
+        rows = (int) floor(height / resolution) + 1;
+
+        distances.assign((long) rows * cols, std::numeric_limits<float>::infinity());
+        nearest.assign((long) rows * cols, -1);
+
+        //seeds - cells along edges, sampled by half of cell
+        for (int s = 0; s < segments.size(); s++) {
+
+            const SEGMENT &segment = segments[s];
+            double length = sqrt(pow(segment.bx - segment.ax, 2.0) + pow(segment.by - segment.ay, 2.0));
+            int steps = std::max(1, (int) ceil(2 * length / resolution));
+
+            for (int i = 0; i <= steps; i++) {
+
+                double t = (double) i / steps;
+                long cell = getCell(segment.ax + t * (segment.bx - segment.ax), segment.ay + t * (segment.by - segment.ay));
+                if (cell < 0)
+                    continue;
+                int row = cell / cols, col = cell % cols;
+
+                double distance = getSegmentDistance(s, row, col);
+                if (distance < distances[cell]) {
+                    distances[cell] = distance;
+                    nearest[cell] = s;
+                }
+            }
+        }
+
+        //forward pass - from top left neighbours, then from the right one
+        for (int row = 0; row < rows; row++) {
+            for (int col = 0; col < cols; col++) {
+                relax(row, col, row, col - 1);
+                relax(row, col, row - 1, col - 1);
+                relax(row, col, row - 1, col);
+                relax(row, col, row - 1, col + 1);
+            }
+            for (int col = cols - 1; col >= 0; col--) {
+                relax(row, col, row, col + 1);
+            }
+        }
+
+        //backward pass - from bottom right neighbours, then from the left one
+        for (int row = rows - 1; row >= 0; row--) {
+            for (int col = cols - 1; col >= 0; col--) {
+                relax(row, col, row, col + 1);
+                relax(row, col, row + 1, col + 1);
+                relax(row, col, row + 1, col);
+                relax(row, col, row + 1, col - 1);
+            }
+            for (int col = 0; col < cols; col++) {
+                relax(row, col, row, col - 1);
+            }
+        }
+    }
+
+    float DistanceField::getDistance(double x, double y) const {
+
+        long cell = getCell(x, y);
+        if (cell < 0)
+            return -1;
+        return distances[cell];
+    }
+
+    bool DistanceField::getNearestEdge(double x, double y, EDGE *edge) const {
+
+        long cell = getCell(x, y);
+        if (cell < 0)
+            return false;
+        *edge = segments[nearest[cell]].edge;
+        return true;
+    }
+
+    unsigned long DistanceField::getVersion() const {
+
+        return version;
+    }
+
+    double DistanceField::getResolution() const {
+
+        return resolution;
+    }
+
+    long DistanceField::getMemory() const {
+
+        return distances.size() * sizeof(float) + nearest.size() * sizeof(int) + segments.size() * sizeof(SEGMENT);
+    }
+
+    /*--------------------PRIVATE FUNCTIONS---------------------*/
+
+    void DistanceField::addSegment(int u, int v, const std::vector<double> &xs, const std::vector<double> &ys) {
+
+        SEGMENT segment = {{u, v}, xs[u], ys[u], xs[v], ys[v]};
+        segments.push_back(segment);
+    }
+
+    //-1 out of the raster
+    long DistanceField::getCell(double x, double y) const {
+
+        if (rows == 0)
+            return -1;
+
+        double col = floor((x - min_x) / resolution);
+        double row = floor((y - min_y) / resolution);
+        if (col < 0 || row < 0 || col >= cols || row >= rows)
+            return -1;
+
+        return (long) row * cols + (long) col;
+    }
+
+    //from centre of the cell
+    double DistanceField::getSegmentDistance(int segment, int row, int col) const {
+
+        const SEGMENT &s = segments[segment];
+        double x = min_x + (col + 0.5) * resolution;
+        double y = min_y + (row + 0.5) * resolution;
+
+        double dx = s.bx - s.ax, dy = s.by - s.ay;
+        double length2 = dx * dx + dy * dy;
+        double t = length2 > 0 ? std::max(0.0, std::min(1.0, ((x - s.ax) * dx + (y - s.ay) * dy) / length2)) : 0;
+
+        return sqrt(pow(s.ax + t * dx - x, 2.0) + pow(s.ay + t * dy - y, 2.0));
+    }
+
+    //nearest edge of the neighbour is tried for the cell
+    void DistanceField::relax(int row, int col, int from_row, int from_col) {
+
+        if (from_row < 0 || from_col < 0 || from_row >= rows || from_col >= cols)
+            return;
+
+        int segment = nearest[(long) from_row * cols + from_col];
+        long cell = (long) row * cols + col;
+        if (segment == -1 || segment == nearest[cell])
+            return;
+
+        double distance = getSegmentDistance(segment, row, col);
+        if (distance < distances[cell]) {
+            distances[cell] = distance;
+            nearest[cell] = segment;
+        }
+    }
+}
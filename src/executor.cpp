@@ -0,0 +1,71 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/executor.h>
+
+namespace osm_planner {
+
+    Executor::Executor() {
+    }
+
+    Executor::~Executor() {
+
+        stop();
+    }
+
+    ros::CallbackQueue *Executor::getLocalizationQueue() {
+
+        return &localization_queue;
+    }
+
+    ros::CallbackQueue *Executor::getPlanningQueue() {
+
+        return &planning_queue;
+    }
+
+    ros::CallbackQueue *Executor::getVisualizationQueue() {
+
+        return &visualization_queue;
+    }
+
+    void Executor::start(int planning_threads) {
+
+        if (planning_threads < 1)
+            planning_threads = 1;
+
+        localization_spinner.reset(new ros::AsyncSpinner(1, &localization_queue));
+        planning_spinner.reset(new ros::AsyncSpinner(planning_threads, &planning_queue));
+        visualization_spinner.reset(new ros::AsyncSpinner(1, &visualization_queue));
+
+        localization_spinner->start();
+        planning_spinner->start();
+        visualization_spinner->start();
+    }
+
+    void Executor::stop() {
+
+        if (localization_spinner)
+            localization_spinner->stop();
+        if (planning_spinner)
+            planning_spinner->stop();
+        if (visualization_spinner)
+            visualization_spinner->stop();
+
+        localization_spinner.reset();
+        planning_spinner.reset();
+        visualization_spinner.reset();
+    }
+
+    void Executor::post(ros::CallbackQueueInterface *queue, boost::function<void()> function) {
+
+        queue->addCallback(ros::CallbackInterfacePtr(new FunctionCallback(function)));
+    }
+
+    /*--------------------PRIVATE FUNCTIONS---------------------*/
+
+    ros::CallbackInterface::CallResult Executor::FunctionCallback::call() {
+
+        function();
+        return Success;
+    }
+}
@@ -0,0 +1,167 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/graph_segment.h>
+
+#include <ros/console.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <new>
+
+namespace osm_planner {
+
+    const char GraphSegment::MAGIC[8] = {'O', 'S', 'M', 'G', 'R', 'A', 'P', 'H'};
+
+    const int GraphSegment::WRITING;
+    const int GraphSegment::READY;
+    const int GraphSegment::REPLACED;
+    const unsigned int GraphSegment::LAYOUT;
+
+    GraphSegment::GraphSegment(std::string name, void *address, size_t size) : name(name), address(address), size(size) {
+
+        char *data = (char *) address;
+        header = (HEADER *) data;
+        int nodes = header->nodes;
+        int slots = header->slots;
+
+        latitudes = (int *) (data + sizeof(HEADER));
+        longitudes = latitudes + nodes;
+        offsets = longitudes + nodes;
+        targets = offsets + nodes + 1;
+        weights = (unsigned int *) (targets + slots);
+    }
+
+    GraphSegment::~GraphSegment() {
+
+        munmap(address, size);
+    }
+
+    boost::shared_ptr<GraphSegment> GraphSegment::create(std::string name, unsigned long version, int nodes, int slots, unsigned int max_weight) {
+
+        std::string shm_name = getShmName(name);
+
+        //attached processes find out, that they use old graph
+        replace(shm_name);
+        shm_unlink(shm_name.c_str());
+
+        int fd = shm_open(shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            ROS_ERROR("OSM planner: Can't create shared graph %s: %s", shm_name.c_str(), strerror(errno));
+            return boost::shared_ptr<GraphSegment>();
+        }
+
+        size_t size = getSize(nodes, slots);
+        if (ftruncate(fd, size) != 0) {
+            ROS_ERROR("OSM planner: Can't allocate %lu bytes of shared graph %s: %s", (unsigned long) size, shm_name.c_str(), strerror(errno));
+            close(fd);
+            shm_unlink(shm_name.c_str());
+            return boost::shared_ptr<GraphSegment>();
+        }
+
+        void *address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) {
+            ROS_ERROR("OSM planner: Can't map shared graph %s: %s", shm_name.c_str(), strerror(errno));
+            shm_unlink(shm_name.c_str());
+            return boost::shared_ptr<GraphSegment>();
+        }
+
+        HEADER *header = new(address) HEADER();
+        memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->layout = LAYOUT;
+        header->state = WRITING;
+        header->version = version;
+        header->nodes = nodes;
+        header->slots = slots;
+        header->max_weight = max_weight;
+        header->size = size;
+
+        return boost::shared_ptr<GraphSegment>(new GraphSegment(name, address, size));
+    }
+
+    boost::shared_ptr<GraphSegment> GraphSegment::attach(std::string name) {
+
+        std::string shm_name = getShmName(name);
+
+        int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return boost::shared_ptr<GraphSegment>();
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(HEADER)) {
+            close(fd);
+            return boost::shared_ptr<GraphSegment>();
+        }
+
+        //size of mapping must match the header
+        size_t size = info.st_size;
+        void *address = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED)
+            return boost::shared_ptr<GraphSegment>();
+
+        const HEADER *header = (const HEADER *) address;
+        if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->layout != LAYOUT || header->state != READY
+            || header->size != size || getSize(header->nodes, header->slots) != size) {
+
+            if (header->state != WRITING && header->state != REPLACED)
+                ROS_WARN_ONCE("OSM planner: Shared graph %s has other layout, it can't be attached", shm_name.c_str());
+            munmap(address, size);
+            return boost::shared_ptr<GraphSegment>();
+        }
+
+        return boost::shared_ptr<GraphSegment>(new GraphSegment(name, address, size));
+    }
+
+    void GraphSegment::setReady() {
+
+        header->state = READY;
+    }
+
+    bool GraphSegment::isReplaced() const {
+
+        return header->state == REPLACED;
+    }
+
+    /*--------------------PRIVATE FUNCTIONS---------------------*/
+
+    std::string GraphSegment::getShmName(std::string name) {
+
+        if (name.empty() || name[0] != '/')
+            return "/" + name;
+        return name;
+    }
+
+    //only header of the old segment is mapped for writing
+    void GraphSegment::replace(std::string shm_name) {
+
+        int fd = shm_open(shm_name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            return;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(HEADER)) {
+            close(fd);
+            return;
+        }
+
+        void *address = mmap(NULL, sizeof(HEADER), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED)
+            return;
+
+        HEADER *header = (HEADER *) address;
+        if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->layout == LAYOUT)
+            header->state = REPLACED;
+        munmap(address, sizeof(HEADER));
+    }
+
+    size_t GraphSegment::getSize(int nodes, int slots) {
+
+        return sizeof(HEADER) + (3 * (size_t) nodes + 1 + 2 * (size_t) slots) * sizeof(int);
+    }
+}
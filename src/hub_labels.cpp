@@ -0,0 +1,207 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/hub_labels.h>
+
+#include <queue>
+#include <functional>
+
+namespace osm_planner {
+
+    HubLabels::HubLabels() : size(0), version(0) {
+    }
+
+    //Pruned landmark labeling - searches from nodes in order of importance,
+    //search is pruned in nodes, whose distance is already covered by labels of more important hubs
+    void HubLabels::build(std::vector<std::vector<float> > *graph, unsigned long version) {
+
+        size = graph->size();
+        this->version = version;
+
+        //adjacency lists - the matrix is too slow for repeated searches
+        std::vector<std::vector<std::pair<int, float> > > adjacency(size);
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                if ((*graph)[i][j])
+                    adjacency[i].push_back(std::make_pair(j, (*graph)[i][j]));
+            }
+        }
+
+        //junctions are more important than nodes inside of ways
+        order.resize(size);
+        std::vector<std::pair<int, int> > degrees(size);
+        for (int i = 0; i < size; i++) {
+            degrees[i] = std::make_pair(-(int) adjacency[i].size(), i);
+        }
+        std::sort(degrees.begin(), degrees.end());
+        for (int i = 0; i < size; i++) {
+            order[i] = degrees[i].second;
+        }
+
+        labels.assign(size, std::vector<LABEL>());
+
+        std::vector<float> distance(size, Dijkstra::INFINITY_DISTANCE);
+        std::vector<int> parent(size, -1);
+        std::vector<float> hubDistance(size, Dijkstra::INFINITY_DISTANCE);  //labels of current root indexed by hub rank
+        std::vector<int> visited;
+
+        typedef std::pair<float, int> QUEUE_ITEM;
+
+        for (int rank = 0; rank < size; rank++) {
+
+            int root = order[rank];
+
+            const std::vector<LABEL> &rootLabels = labels[root];
+            for (int i = 0; i < rootLabels.size(); i++) {
+                hubDistance[rootLabels[i].hub] = rootLabels[i].distance;
+            }
+
+            std::priority_queue<QUEUE_ITEM, std::vector<QUEUE_ITEM>, std::greater<QUEUE_ITEM> > queue;
+            distance[root] = 0;
+            parent[root] = -1;
+            visited.push_back(root);
+            queue.push(std::make_pair(0.0f, root));
+
+            while (!queue.empty()) {
+
+                QUEUE_ITEM item = queue.top();
+                queue.pop();
+                int u = item.second;
+                if (item.first > distance[u])
+                    continue;
+
+                //prune - the distance is covered by more important hub
+                bool pruned = false;
+                const std::vector<LABEL> &nodeLabels = labels[u];
+                for (int i = 0; i < nodeLabels.size(); i++) {
+                    if (hubDistance[nodeLabels[i].hub] != Dijkstra::INFINITY_DISTANCE &&
+                        hubDistance[nodeLabels[i].hub] + nodeLabels[i].distance <= item.first) {
+                        pruned = true;
+                        break;
+                    }
+                }
+                if (pruned)
+                    continue;
+
+                LABEL label = {rank, item.first, parent[u]};
+                labels[u].push_back(label);
+
+                for (int i = 0; i < adjacency[u].size(); i++) {
+                    int v = adjacency[u][i].first;
+                    float dist = item.first + adjacency[u][i].second;
+                    if (dist < distance[v]) {
+                        if (distance[v] == Dijkstra::INFINITY_DISTANCE)
+                            visited.push_back(v);
+                        distance[v] = dist;
+                        parent[v] = u;
+                        queue.push(std::make_pair(dist, v));
+                    }
+                }
+            }
+
+            //reset arrays only for touched nodes
+            for (int i = 0; i < visited.size(); i++) {
+                distance[visited[i]] = Dijkstra::INFINITY_DISTANCE;
+            }
+            visited.clear();
+            for (int i = 0; i < rootLabels.size(); i++) {
+                hubDistance[rootLabels[i].hub] = Dijkstra::INFINITY_DISTANCE;
+            }
+        }
+    }
+
+    bool HubLabels::isReady(unsigned long version) {
+
+        return this->version == version && !labels.empty();
+    }
+
+    float HubLabels::getDistance(int source, int target) {
+
+        int hub;
+        return query(source, target, &hub);
+    }
+
+    std::vector<int> HubLabels::getPath(int source, int target) {
+
+        std::vector<int> path;
+
+        int hub;
+        if (query(source, target, &hub) == Dijkstra::INFINITY_DISTANCE)
+            return path;
+
+        //source -> hub and target -> hub, the second part is reversed
+        std::vector<int> back;
+        appendPathToHub(source, hub, &path);
+        appendPathToHub(target, hub, &back);
+
+        //hub is on the end of both parts
+        back.pop_back();
+        path.insert(path.end(), back.rbegin(), back.rend());
+        return path;
+    }
+
+    long HubLabels::getLabelsSize() {
+
+        long count = 0;
+        for (int i = 0; i < labels.size(); i++) {
+            count += labels[i].size();
+        }
+        return count;
+    }
+
+    //merge of two sorted lists
+    float HubLabels::query(int source, int target, int *hub) {
+
+        const std::vector<LABEL> &s = labels[source];
+        const std::vector<LABEL> &t = labels[target];
+
+        float best = Dijkstra::INFINITY_DISTANCE;
+        *hub = -1;
+
+        int i = 0, j = 0;
+        while (i < s.size() && j < t.size()) {
+            if (s[i].hub < t[j].hub) {
+                i++;
+            } else if (s[i].hub > t[j].hub) {
+                j++;
+            } else {
+                if (s[i].distance + t[j].distance < best) {
+                    best = s[i].distance + t[j].distance;
+                    *hub = s[i].hub;
+                }
+                i++;
+                j++;
+            }
+        }
+        return best;
+    }
+
+    const HubLabels::LABEL *HubLabels::findLabel(int node, int hub) {
+
+        const std::vector<LABEL> &nodeLabels = labels[node];
+
+        int low = 0, high = nodeLabels.size() - 1;
+        while (low <= high) {
+            int middle = (low + high) / 2;
+            if (nodeLabels[middle].hub == hub)
+                return &nodeLabels[middle];
+            if (nodeLabels[middle].hub < hub)
+                low = middle + 1;
+            else
+                high = middle - 1;
+        }
+        return NULL;
+    }
+
+    //every node on the path to the hub was expanded in the search from hub, so it has the hub in labels too
+    void HubLabels::appendPathToHub(int node, int hub, std::vector<int> *path) {
+
+        for (const LABEL *label = findLabel(node, hub); label; ) {
+            path->push_back(node);
+            node = label->parent;
+            if (node == -1)
+                break;
+            label = findLabel(node, hub);
+        }
+    }
+}
@@ -0,0 +1,181 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/landmarks.h>
+
+#include <fstream>
+#include <cstring>
+#include <cmath>
+
+namespace osm_planner {
+
+    static const char LANDMARKS_MAGIC[8] = {'O', 'S', 'M', 'L', 'M', 'K', '0', '1'};
+
+    Landmarks::Landmarks() : size(0), version(0), edges(0), length(0) {
+    }
+
+    void Landmarks::build(std::vector<std::vector<float> > *graph, int count, unsigned long version) {
+
+        size = graph->size();
+        this->version = version;
+        landmarks.clear();
+        distances.clear();
+        computeSignature(graph, &edges, &length);
+
+        if (size == 0 || count <= 0)
+            return;
+
+        std::vector<int> all(size);
+        for (int i = 0; i < size; i++) {
+            all[i] = i;
+        }
+
+        Dijkstra dijkstra;
+
+        //the first landmark is the node farthest from node 0
+        std::vector<float> fromStart = dijkstra.findDistances(graph, 0, all);
+        int next = 0;
+        for (int i = 0; i < size; i++) {
+            if (fromStart[i] != Dijkstra::INFINITY_DISTANCE && fromStart[i] > fromStart[next])
+                next = i;
+        }
+
+        //distance of every node to the nearest selected landmark
+        std::vector<float> nearest(size, Dijkstra::INFINITY_DISTANCE);
+
+        while (landmarks.size() < count) {
+
+            landmarks.push_back(next);
+            distances.push_back(dijkstra.findDistances(graph, next, all));
+
+            const std::vector<float> &d = distances.back();
+            for (int i = 0; i < size; i++) {
+                if (d[i] < nearest[i])
+                    nearest[i] = d[i];
+            }
+
+            //next landmark is the reachable node farthest from all selected landmarks
+            next = -1;
+            for (int i = 0; i < size; i++) {
+                if (nearest[i] != Dijkstra::INFINITY_DISTANCE && nearest[i] > 0 && (next == -1 || nearest[i] > nearest[next]))
+                    next = i;
+            }
+            if (next == -1)
+                break;
+        }
+    }
+
+    bool Landmarks::save(std::string file) {
+
+        std::ofstream out(file.c_str(), std::ios::binary);
+        if (!out)
+            return false;
+
+        unsigned int count = landmarks.size();
+
+        out.write(LANDMARKS_MAGIC, sizeof(LANDMARKS_MAGIC));
+        out.write((const char *) &size, sizeof(size));
+        out.write((const char *) &edges, sizeof(edges));
+        out.write((const char *) &length, sizeof(length));
+        out.write((const char *) &count, sizeof(count));
+        out.write((const char *) landmarks.data(), count * sizeof(int));
+
+        for (int i = 0; i < count; i++) {
+            out.write((const char *) distances[i].data(), size * sizeof(float));
+        }
+        return out.good();
+    }
+
+    bool Landmarks::load(std::string file, std::vector<std::vector<float> > *graph, unsigned long version) {
+
+        std::ifstream in(file.c_str(), std::ios::binary);
+        if (!in)
+            return false;
+
+        char magic[sizeof(LANDMARKS_MAGIC)];
+        int file_size;
+        unsigned int file_edges, count;
+        double file_length;
+
+        in.read(magic, sizeof(magic));
+        in.read((char *) &file_size, sizeof(file_size));
+        in.read((char *) &file_edges, sizeof(file_edges));
+        in.read((char *) &file_length, sizeof(file_length));
+        in.read((char *) &count, sizeof(count));
+
+        if (!in || memcmp(magic, LANDMARKS_MAGIC, sizeof(magic)) != 0)
+            return false;
+
+        //file was created for other graph
+        unsigned int graph_edges;
+        double graph_length;
+        computeSignature(graph, &graph_edges, &graph_length);
+        if (file_size != graph->size() || file_edges != graph_edges || fabs(file_length - graph_length) > 1e-3 * graph_length + 1e-6)
+            return false;
+
+        std::vector<int> file_landmarks(count);
+        std::vector<std::vector<float> > file_distances(count, std::vector<float>(file_size));
+
+        in.read((char *) file_landmarks.data(), count * sizeof(int));
+        for (int i = 0; i < count; i++) {
+            in.read((char *) file_distances[i].data(), file_size * sizeof(float));
+        }
+        if (!in)
+            return false;
+
+        size = file_size;
+        this->version = version;
+        edges = file_edges;
+        length = file_length;
+        landmarks.swap(file_landmarks);
+        distances.swap(file_distances);
+        return true;
+    }
+
+    bool Landmarks::isReady(unsigned long version) {
+
+        return !landmarks.empty() && this->version == version;
+    }
+
+    int Landmarks::getCount() {
+
+        return landmarks.size();
+    }
+
+    void Landmarks::getLowerBounds(int target, std::vector<float> *bounds) {
+
+        bounds->assign(size, 0);
+
+        for (int l = 0; l < landmarks.size(); l++) {
+
+            const std::vector<float> &d = distances[l];
+            float toTarget = d[target];
+            if (toTarget == Dijkstra::INFINITY_DISTANCE)
+                continue;
+
+            for (int i = 0; i < size; i++) {
+                if (d[i] == Dijkstra::INFINITY_DISTANCE)
+                    continue;
+
+                float bound = fabs(toTarget - d[i]);
+                if (bound > (*bounds)[i])
+                    (*bounds)[i] = bound;
+            }
+        }
+    }
+
+    void Landmarks::computeSignature(std::vector<std::vector<float> > *graph, unsigned int *edges, double *length) {
+
+        *edges = 0;
+        *length = 0;
+
+        for (int i = 0; i < graph->size(); i++) {
+            for (int j = 0; j < (*graph)[i].size(); j++) {
+                if ((*graph)[i][j]) {
+                    (*edges)++;
+                    *length += (*graph)[i][j];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,314 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/map_matcher.h>
+
+#include <boost/unordered_set.hpp>
+#include <boost/chrono.hpp>
+#include <algorithm>
+#include <queue>
+#include <limits>
+
+namespace osm_planner {
+
+    const int MapMatcher::MAX_CACHED_SOURCES;
+
+    MapMatcher::MapMatcher(Parser *map) : map(map), version(0), over_budget(0) {
+
+        setParams(5.0, 2.0, 25.0, 8, 10, 0.002);
+    }
+
+    void MapMatcher::setParams(double sigma, double beta, double search_radius, int max_candidates, int window_size, double time_budget) {
+
+        this->sigma = std::max(sigma, 0.1);
+        this->beta = std::max(beta, 0.1);
+        this->search_radius = search_radius;
+        this->max_candidates = std::max(max_candidates, 1);
+        this->window_size = std::max(window_size, 1);
+        this->time_budget = time_budget;
+        reset();
+    }
+
+    bool MapMatcher::addFix(double latitude, double longitude, double sigma, MATCH *match) {
+
+        boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+        if (sigma <= 0)
+            sigma = this->sigma;
+
+        Parser::GraphLock graph_lock(map);
+        boost::shared_ptr<Parser::GRAPH> graph = map->getGraph();
+        const IntegerGraph &integer_graph = graph->integer_graph;
+
+        //IDs of nodes and cached routes are valid only for one graph
+        unsigned long graph_version = map->getGraphVersion();
+        if (graph_version != version) {
+            reset();
+            version = graph_version;
+        }
+
+        LAYER layer;
+        layer.fix = Parser::OSM_NODE();
+        layer.fix.latitude = latitude;
+        layer.fix.longitude = longitude;
+        findCandidates(graph.get(), layer.fix, sigma, &layer.candidates);
+
+        //robot is out of the roads, the sequence starts again on the next fix
+        if (layer.candidates.empty()) {
+            window.clear();
+            return false;
+        }
+
+        if (!window.empty()) {
+
+            const LAYER &last = window.back();
+            double straight = Parser::Haversine::getDistance(last.fix, layer.fix);
+            double bound = 2 * straight + 2 * search_radius;
+
+            bool connected = false;
+            bool exceeded = false;
+            std::vector<CANDIDATE> candidates;
+
+            for (int i = 0; i < layer.candidates.size(); i++) {
+
+                CANDIDATE &candidate = layer.candidates[i];
+                double best = -std::numeric_limits<double>::infinity();
+                int previous = -1;
+
+                for (int j = 0; j < last.candidates.size(); j++) {
+
+                    if (!exceeded && boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count() > time_budget)
+                        exceeded = true;
+
+                    double route = exceeded ? getStraightDistance(last.candidates[j], candidate)
+                                            : getRouteDistance(integer_graph, last.candidates[j], candidate, bound);
+                    if (route < 0)
+                        continue;
+
+                    double score = last.candidates[j].score - fabs(route - straight) / beta;
+                    if (score > best) {
+                        best = score;
+                        previous = j;
+                    }
+                }
+
+                //candidates, which can't be reached from the previous fix, aren't used
+                if (previous != -1) {
+                    candidate.score += best;
+                    candidate.previous = previous;
+                    candidates.push_back(candidate);
+                    connected = true;
+                }
+            }
+
+            if (exceeded)
+                over_budget++;
+
+            //no route from the previous candidates, the sequence starts again by this fix
+            if (connected)
+                layer.candidates.swap(candidates);
+            else
+                window.clear();
+        }
+
+        //scores are relative to the best one, so they don't drift
+        layer.best = 0;
+        for (int i = 1; i < layer.candidates.size(); i++) {
+            if (layer.candidates[i].score > layer.candidates[layer.best].score)
+                layer.best = i;
+        }
+        double best_score = layer.candidates[layer.best].score;
+        for (int i = 0; i < layer.candidates.size(); i++)
+            layer.candidates[i].score -= best_score;
+
+        window.push_back(layer);
+        if (window.size() > window_size) {
+            window.pop_front();
+            for (int i = 0; i < window.front().candidates.size(); i++)
+                window.front().candidates[i].previous = -1;
+        }
+
+        *match = window.back().candidates[window.back().best].match;
+        return true;
+    }
+
+    void MapMatcher::getPath(std::vector<MATCH> *path) {
+
+        path->clear();
+        if (window.empty())
+            return;
+
+        int index = window.back().best;
+        for (int i = window.size() - 1; i >= 0 && index != -1; i--) {
+            path->push_back(window[i].candidates[index].match);
+            index = window[i].candidates[index].previous;
+        }
+        std::reverse(path->begin(), path->end());
+    }
+
+    void MapMatcher::reset() {
+
+        window.clear();
+        reach_cache.clear();
+    }
+
+    int MapMatcher::getOverBudget() const {
+
+        return over_budget;
+    }
+
+    /*--------------------PRIVATE FUNCTIONS---------------------*/
+
+    //edges of nodes around the fix, projections are computed in local plane of the fix
+    void MapMatcher::findCandidates(Parser::GRAPH *graph, Parser::OSM_NODE fix, double sigma, std::vector<CANDIDATE> *candidates) {
+
+        const IntegerGraph &integer_graph = graph->integer_graph;
+        const NodeStore<Parser::OSM_NODE> &nodes = graph->nodes;
+
+        //edge can be near the fix, although its nodes are out of the search radius, one of them is at most
+        //half of the edge farther than the projection
+        double max_edge = integer_graph.getMaxWeight() / 100.0;
+        std::vector<int> ids = map->getPointsInRadius(fix.latitude, fix.longitude, search_radius + max_edge / 2);
+
+        //metres per degree of latitude, the same sphere as Haversine
+        Parser::OSM_NODE north = fix;
+        north.latitude += 0.001;
+        const double metres = Parser::Haversine::getDistance(fix, north) / 0.001;
+        double cos_latitude = cos(fix.latitude * M_PI / 180);
+
+        boost::unordered_set<long long> edges;
+        for (int i = 0; i < ids.size(); i++) {
+
+            int u = ids[i];
+            if (u >= integer_graph.size())
+                continue;
+
+            for (int e = integer_graph.begin(u); e < integer_graph.end(u); e++) {
+
+                int v = integer_graph.target(e);
+                int source = std::min(u, v), target = std::max(u, v);
+                if (!edges.insert(((long long) source << 32) | target).second)
+                    continue;
+
+                Parser::OSM_NODE a = nodes[source], b = nodes[target];
+                double ax = (a.longitude - fix.longitude) * cos_latitude * metres;
+                double ay = (a.latitude - fix.latitude) * metres;
+                double dx = (b.longitude - fix.longitude) * cos_latitude * metres - ax;
+                double dy = (b.latitude - fix.latitude) * metres - ay;
+
+                double length2 = dx * dx + dy * dy;
+                double offset = length2 > 0 ? std::max(0.0, std::min(1.0, -(ax * dx + ay * dy) / length2)) : 0;
+                double x = ax + offset * dx;
+                double y = ay + offset * dy;
+                double distance = sqrt(x * x + y * y);
+
+                if (distance > search_radius)
+                    continue;
+
+                CANDIDATE candidate;
+                candidate.match.source = source;
+                candidate.match.target = target;
+                candidate.match.node = offset < 0.5 ? source : target;
+                candidate.match.offset = offset;
+                candidate.match.distance = distance;
+                candidate.match.point = Parser::OSM_NODE();
+                candidate.match.point.latitude = fix.latitude + y / metres;
+                candidate.match.point.longitude = fix.longitude + x / (metres * cos_latitude);
+                candidate.length = sqrt(length2);
+                candidate.score = -0.5 * (distance / sigma) * (distance / sigma);
+                candidate.previous = -1;
+                candidates->push_back(candidate);
+            }
+        }
+
+        std::sort(candidates->begin(), candidates->end(), compareByDistance);
+        if (candidates->size() > max_candidates)
+            candidates->resize(max_candidates);
+    }
+
+    double MapMatcher::getRouteDistance(const IntegerGraph &graph, const CANDIDATE &from, const CANDIDATE &to, double bound) {
+
+        //along the same edge
+        if (from.match.source == to.match.source && from.match.target == to.match.target)
+            return fabs(to.match.offset - from.match.offset) * from.length;
+
+        int from_nodes[2] = {from.match.source, from.match.target};
+        double from_costs[2] = {from.match.offset * from.length, (1 - from.match.offset) * from.length};
+        int to_nodes[2] = {to.match.source, to.match.target};
+        double to_costs[2] = {to.match.offset * to.length, (1 - to.match.offset) * to.length};
+
+        double best = -1;
+        for (int i = 0; i < 2; i++) {
+
+            //reference is valid only until the next search
+            const REACH &reach = getReach(graph, from_nodes[i], (unsigned int) (bound * 100));
+            for (int j = 0; j < 2; j++) {
+
+                boost::unordered_map<int, unsigned int>::const_iterator distance = reach.distances.find(to_nodes[j]);
+                if (distance == reach.distances.end())
+                    continue;
+
+                double route = from_costs[i] + distance->second / 100.0 + to_costs[j];
+                if (best < 0 || route < best)
+                    best = route;
+            }
+        }
+
+        return best > bound ? -1 : best;
+    }
+
+    //Dijkstra from the source, which stops at bound [cm]
+    const MapMatcher::REACH &MapMatcher::getReach(const IntegerGraph &graph, int source, unsigned int bound) {
+
+        boost::unordered_map<int, REACH>::iterator cached = reach_cache.find(source);
+        if (cached != reach_cache.end() && cached->second.bound >= bound)
+            return cached->second;
+
+        if (cached == reach_cache.end() && reach_cache.size() >= MAX_CACHED_SOURCES)
+            reach_cache.clear();
+
+        REACH &reach = reach_cache[source];
+        reach.bound = bound;
+        reach.distances.clear();
+        reach.distances[source] = 0;
+
+        typedef std::pair<unsigned int, int> ITEM;
+        std::priority_queue<ITEM, std::vector<ITEM>, std::greater<ITEM> > queue;
+        queue.push(ITEM(0, source));
+
+        while (!queue.empty()) {
+
+            ITEM item = queue.top();
+            queue.pop();
+            int u = item.second;
+            if (item.first > reach.distances[u])
+                continue;
+
+            for (int e = graph.begin(u); e < graph.end(u); e++) {
+
+                unsigned int weight = graph.weight(e);
+                if (weight == IntegerGraph::INFINITY_WEIGHT || item.first + weight > bound)
+                    continue;
+
+                int v = graph.target(e);
+                unsigned int distance = item.first + weight;
+                boost::unordered_map<int, unsigned int>::iterator known = reach.distances.find(v);
+                if (known == reach.distances.end() || distance < known->second) {
+                    reach.distances[v] = distance;
+                    queue.push(ITEM(distance, v));
+                }
+            }
+        }
+        return reach;
+    }
+
+    double MapMatcher::getStraightDistance(const CANDIDATE &from, const CANDIDATE &to) {
+
+        return Parser::Haversine::getDistance(from.match.point, to.match.point);
+    }
+
+    bool MapMatcher::compareByDistance(const CANDIDATE &a, const CANDIDATE &b) {
+
+        return a.match.distance < b.match.distance;
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * map_tiler.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: michal
+ */
+
+#include <osm_planner/osm_parser.h>
+#include <osm_planner/tile_cache.h>
+
+#include <fstream>
+#include <map>
+#include <set>
+
+//Compiles OSM map for on-demand loading - selected ways are split into tiles of global lat/lon grid.
+//Way is written to every tile, which contains some of its nodes, together with coordinates of all its nodes,
+//so every tile can be loaded alone. Tags are not written, ways in tiles are already filtered.
+
+typedef std::pair<int, int> TILE_ID;
+
+typedef struct tile {
+    std::vector<TiXmlElement *> ways;
+    std::set<int> nodes;
+} TILE;
+
+int main(int argc, char **argv) {
+
+    ros::init(argc, argv, "map_tiler");
+    ros::NodeHandle n("~");
+
+    std::string file = "skuska.osm";
+    n.getParam("osm_map_path", file);
+
+    std::vector<std::string> types_of_ways;
+    n.getParam("filter_of_ways", types_of_ways);
+
+    std::string directory;
+    n.param<std::string>("tiles_directory", directory, file + ".tiles");
+
+    double tile_size;
+    n.param<double>("tile_size", tile_size, 0.01);
+
+    TiXmlDocument doc(file);
+    if (!doc.LoadFile()) {
+        ROS_ERROR("Map tiler: Failed to load file %s", file.c_str());
+        return 1;
+    }
+
+    TiXmlElement *root = doc.FirstChildElement("osm");
+    if (!root) {
+        ROS_ERROR("Map tiler: File %s isn't OSM map", file.c_str());
+        return 1;
+    }
+
+    std::map<int, osm_planner::Parser::OSM_NODE> nodes;
+    for (TiXmlElement *element = root->FirstChildElement("node"); element; element = element->NextSiblingElement("node")) {
+
+        int id;
+        osm_planner::Parser::OSM_NODE node = {0, 0, 0, 0};
+        element->Attribute("id", &id);
+        element->Attribute("lat", &node.latitude);
+        element->Attribute("lon", &node.longitude);
+        nodes[id] = node;
+    }
+
+    std::map<TILE_ID, TILE> tiles;
+    int count_of_ways = 0;
+
+    for (TiXmlElement *way = root->FirstChildElement("way"); way; way = way->NextSiblingElement("way")) {
+
+        bool selected = false;
+        for (TiXmlElement *tag = way->FirstChildElement("tag"); tag && !selected; tag = tag->NextSiblingElement("tag")) {
+            selected = osm_planner::Parser::isSelectedWay(tag, types_of_ways);
+        }
+        if (!selected)
+            continue;
+
+        std::vector<int> refs;
+        std::set<TILE_ID> way_tiles;
+        for (TiXmlElement *nd = way->FirstChildElement("nd"); nd && selected; nd = nd->NextSiblingElement("nd")) {
+
+            int ref;
+            nd->Attribute("ref", &ref);
+
+            std::map<int, osm_planner::Parser::OSM_NODE>::iterator node = nodes.find(ref);
+            if (node == nodes.end()) {
+                ROS_WARN("Map tiler: Way uses unknown node %d, it is skipped", ref);
+                selected = false;
+                break;
+            }
+
+            refs.push_back(ref);
+            way_tiles.insert(TILE_ID((int) floor(node->second.latitude / tile_size), (int) floor(node->second.longitude / tile_size)));
+        }
+        if (!selected)
+            continue;
+
+        for (std::set<TILE_ID>::iterator it = way_tiles.begin(); it != way_tiles.end(); it++) {
+            tiles[*it].ways.push_back(way);
+            tiles[*it].nodes.insert(refs.begin(), refs.end());
+        }
+        count_of_ways++;
+    }
+
+    std::ofstream index((directory + "/" + osm_planner::TileCache::INDEX_FILE).c_str());
+    if (!index) {
+        ROS_ERROR("Map tiler: Can't write to directory %s, it must exist", directory.c_str());
+        return 1;
+    }
+    index.precision(12);
+    index << tile_size << std::endl;
+
+    for (std::map<TILE_ID, TILE>::iterator tile = tiles.begin(); tile != tiles.end(); tile++) {
+
+        TiXmlDocument out;
+        out.LinkEndChild(new TiXmlDeclaration("1.0", "UTF-8", ""));
+        TiXmlElement *osm = new TiXmlElement("osm");
+        osm->SetAttribute("version", "0.6");
+        osm->SetAttribute("generator", "map_tiler");
+        out.LinkEndChild(osm);
+
+        for (std::set<int>::iterator ref = tile->second.nodes.begin(); ref != tile->second.nodes.end(); ref++) {
+            TiXmlElement *node = new TiXmlElement("node");
+            node->SetAttribute("id", *ref);
+            node->SetDoubleAttribute("lat", nodes[*ref].latitude);
+            node->SetDoubleAttribute("lon", nodes[*ref].longitude);
+            osm->LinkEndChild(node);
+        }
+
+        for (int i = 0; i < tile->second.ways.size(); i++) {
+
+            int id;
+            tile->second.ways[i]->Attribute("id", &id);
+            TiXmlElement *way = new TiXmlElement("way");
+            way->SetAttribute("id", id);
+
+            for (TiXmlElement *nd = tile->second.ways[i]->FirstChildElement("nd"); nd; nd = nd->NextSiblingElement("nd")) {
+                int ref;
+                nd->Attribute("ref", &ref);
+                TiXmlElement *new_nd = new TiXmlElement("nd");
+                new_nd->SetAttribute("ref", ref);
+                way->LinkEndChild(new_nd);
+            }
+            osm->LinkEndChild(way);
+        }
+
+        std::string tile_file = osm_planner::TileCache::getTileFile(directory, tile->first);
+        if (!out.SaveFile(tile_file)) {
+            ROS_ERROR("Map tiler: Can't write tile %s", tile_file.c_str());
+            return 1;
+        }
+        index << tile->first.first << " " << tile->first.second << std::endl;
+    }
+
+    ROS_INFO("Map tiler: %d ways of %s were split into %d tiles of %f deg in %s", count_of_ways, file.c_str(),
+             (int) tiles.size(), tile_size, directory.c_str());
+    return 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * matching_benchmark.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: michal
+ */
+
+#include <osm_planner/osm_parser.h>
+#include <osm_planner/graph_search.h>
+#include <osm_planner/map_matcher.h>
+
+#include <boost/chrono.hpp>
+#include <boost/unordered_set.hpp>
+#include <fstream>
+#include <random>
+
+//Throughput of HMM map matching on replayed gps traces. Traces are read from csv file (latitude,longitude on every line)
+//or generated along random routes with gaussian noise. Map matching is compared with snapping to the nearest node,
+//for generated traces the share of fixes, which are matched to node of the true route, is printed.
+
+typedef struct trace {
+    std::vector<osm_planner::Parser::OSM_NODE> fixes;
+    boost::unordered_set<int> route;    //nodes of the true route, empty for replayed trace
+} TRACE;
+
+typedef struct result {
+    double time;
+    double max_latency;
+    int fixes;
+    int matched;
+    int on_route;
+} RESULT;
+
+bool loadTrace(std::string file, TRACE *trace) {
+
+    std::ifstream input(file.c_str());
+    if (!input.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        osm_planner::Parser::OSM_NODE fix = osm_planner::Parser::OSM_NODE();
+        if (sscanf(line.c_str(), "%lf,%lf", &fix.latitude, &fix.longitude) == 2)
+            trace->fixes.push_back(fix);
+    }
+    return !trace->fixes.empty();
+}
+
+//fixes every spacing metres along the shortest path between random nodes
+bool generateTrace(osm_planner::Parser *map, osm_planner::RadixHeapSearch *search, double noise, double spacing,
+                   std::mt19937 *generator, TRACE *trace) {
+
+    osm_planner::Parser::GraphLock lock(map);
+    const osm_planner::IntegerGraph &graph = *map->getIntegerGraph();
+    std::uniform_int_distribution<int> random_node(0, graph.size() - 1);
+    std::normal_distribution<double> random_noise(0, noise);
+
+    std::vector<int> path;
+    try {
+        path = search->findShortestPath(graph, random_node(*generator), random_node(*generator));
+    } catch (osm_planner::dijkstra_exception &e) {
+        return false;
+    }
+    if (path.size() < 2)
+        return false;
+
+    //distance from the start of segment to its first fix
+    double carry = 0;
+    for (int i = 1; i < path.size(); i++) {
+
+        osm_planner::Parser::OSM_NODE a = map->getNodeByID(path[i - 1]);
+        osm_planner::Parser::OSM_NODE b = map->getNodeByID(path[i]);
+        double length = osm_planner::Parser::Haversine::getDistance(a, b);
+
+        osm_planner::Parser::OSM_NODE north = a;
+        north.latitude += 0.001;
+        double metres = osm_planner::Parser::Haversine::getDistance(a, north) / 0.001;
+
+        double position = carry;
+        for (; position < length; position += spacing) {
+            double t = position / length;
+            osm_planner::Parser::OSM_NODE fix = osm_planner::Parser::OSM_NODE();
+            fix.latitude = a.latitude + t * (b.latitude - a.latitude) + random_noise(*generator) / metres;
+            fix.longitude = a.longitude + t * (b.longitude - a.longitude)
+                            + random_noise(*generator) / (metres * cos(a.latitude * M_PI / 180));
+            trace->fixes.push_back(fix);
+        }
+        carry = position - length;
+        trace->route.insert(path[i - 1]);
+        trace->route.insert(path[i]);
+    }
+    return true;
+}
+
+RESULT matchTraces(osm_planner::MapMatcher *matcher, const std::vector<TRACE> &traces) {
+
+    RESULT result = {0, 0, 0, 0, 0};
+
+    for (int i = 0; i < traces.size(); i++) {
+
+        matcher->reset();
+        for (int j = 0; j < traces[i].fixes.size(); j++) {
+
+            boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+            osm_planner::MapMatcher::MATCH match;
+            bool matched = matcher->addFix(traces[i].fixes[j].latitude, traces[i].fixes[j].longitude, 0, &match);
+            double latency = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+            result.time += latency;
+            result.max_latency = std::max(result.max_latency, latency);
+            result.fixes++;
+            if (matched) {
+                result.matched++;
+                if (traces[i].route.count(match.node))
+                    result.on_route++;
+            }
+        }
+    }
+    return result;
+}
+
+RESULT snapTraces(osm_planner::Parser *map, const std::vector<TRACE> &traces) {
+
+    RESULT result = {0, 0, 0, 0, 0};
+
+    for (int i = 0; i < traces.size(); i++) {
+        for (int j = 0; j < traces[i].fixes.size(); j++) {
+
+            boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+            int node = map->getNearestPoint(traces[i].fixes[j].latitude, traces[i].fixes[j].longitude);
+            double latency = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+            result.time += latency;
+            result.max_latency = std::max(result.max_latency, latency);
+            result.fixes++;
+            result.matched++;
+            if (traces[i].route.count(node))
+                result.on_route++;
+        }
+    }
+    return result;
+}
+
+void printResult(std::string name, RESULT result, bool generated) {
+
+    ROS_INFO("Benchmark: %-14s %10.0f fixes/s, mean %.3f ms, max %.3f ms, matched %d/%d, on true route %s%.1f %%",
+             name.c_str(), result.fixes / std::max(result.time, 1e-9), result.time * 1000 / std::max(result.fixes, 1),
+             result.max_latency * 1000, result.matched, result.fixes, generated ? "" : "(unknown) ",
+             generated ? 100.0 * result.on_route / std::max(result.fixes, 1) : 0.0);
+}
+
+int main(int argc, char **argv) {
+
+    ros::init(argc, argv, "matching_benchmark");
+    ros::NodeHandle n("~");
+
+    std::string file = "skuska.osm";
+    n.getParam("osm_map_path", file);
+
+    std::vector<std::string> types_of_ways;
+    n.getParam("filter_of_ways", types_of_ways);
+
+    double interpolation_max_distance;
+    n.param<double>("interpolation_max_distance", interpolation_max_distance, 2.0);
+
+    //replayed trace or generated traces
+    std::string trace_file;
+    int count_of_traces;
+    double noise, fix_spacing;
+    n.param<std::string>("trace_file", trace_file, "");
+    n.param<int>("traces", count_of_traces, 20);
+    n.param<double>("noise", noise, 5.0);
+    n.param<double>("fix_spacing", fix_spacing, 1.0);
+
+    double sigma, beta, radius, budget;
+    int candidates, window;
+    n.param<double>("map_matching_sigma", sigma, noise);
+    n.param<double>("map_matching_beta", beta, 2.0);
+    n.param<double>("map_matching_radius", radius, 25.0);
+    n.param<int>("map_matching_candidates", candidates, 8);
+    n.param<int>("map_matching_window", window, 10);
+    n.param<double>("map_matching_budget", budget, 0.002);
+
+    osm_planner::Parser map(file);
+    map.setTypeOfWays(types_of_ways);
+    map.setInterpolationMaxDistance(interpolation_max_distance);
+    map.parse();
+
+    std::vector<TRACE> traces;
+    bool generated = trace_file.empty();
+
+    if (!generated) {
+        TRACE trace;
+        if (!loadTrace(trace_file, &trace)) {
+            ROS_ERROR("OSM planner: Can't read trace %s", trace_file.c_str());
+            return 1;
+        }
+        traces.push_back(trace);
+    } else {
+        std::mt19937 generator(0);
+        osm_planner::RadixHeapSearch search;
+        for (int attempt = 0; traces.size() < count_of_traces && attempt < 10 * count_of_traces; attempt++) {
+            TRACE trace;
+            if (generateTrace(&map, &search, noise, fix_spacing, &generator, &trace))
+                traces.push_back(trace);
+        }
+    }
+
+    int fixes = 0;
+    for (int i = 0; i < traces.size(); i++)
+        fixes += traces[i].fixes.size();
+
+    ROS_INFO("Benchmark: map %s, %d nodes, %d traces, %d fixes, noise %.1f m", file.c_str(),
+             map.getIntegerGraph()->size(), (int) traces.size(), fixes, generated ? noise : 0.0);
+
+    RESULT nearest_result = snapTraces(&map, traces);
+    printResult("nearest_node", nearest_result, generated);
+
+    osm_planner::MapMatcher matcher(&map);
+    matcher.setParams(sigma, beta, radius, candidates, window, budget);
+    RESULT matcher_result = matchTraces(&matcher, traces);
+    printResult("hmm", matcher_result, generated);
+
+    ROS_INFO("Benchmark: %d fixes ran out of time budget %.3f ms", matcher.getOverBudget(), budget * 1000);
+
+    return 0;
+}
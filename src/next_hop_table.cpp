@@ -0,0 +1,77 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/next_hop_table.h>
+
+#include <boost/thread.hpp>
+
+namespace osm_planner {
+
+    NextHopTable::NextHopTable() : size(0), version(0) {
+    }
+
+    void NextHopTable::build(const IntegerGraph &graph, unsigned long version, int threads) {
+
+        size = graph.size();
+        this->version = version;
+        next_hop.assign((long) size * size, -1);
+        distances.assign((long) size * size, IntegerGraph::INFINITY_WEIGHT);
+
+        boost::atomic<int> next_target(0);
+        boost::thread_group group;
+        for (int i = 1; i < threads; i++) {
+            group.create_thread(boost::bind(&NextHopTable::buildRows, this, &graph, &next_target));
+        }
+        buildRows(&graph, &next_target);
+        group.join_all();
+    }
+
+    //the graph is undirected, so parent of node in the tree from target is the next hop towards target
+    void NextHopTable::buildRows(const IntegerGraph *graph, boost::atomic<int> *next_target) {
+
+        RadixHeapSearch search;
+
+        for (int target = (*next_target)++; target < size; target = (*next_target)++) {
+
+            search.findDistances(*graph, target);
+            const std::vector<int> &parents = search.getParents();
+            const std::vector<unsigned int> &distance = search.getDistances();
+
+            std::copy(parents.begin(), parents.end(), next_hop.begin() + (long) target * size);
+            std::copy(distance.begin(), distance.end(), distances.begin() + (long) target * size);
+        }
+    }
+
+    bool NextHopTable::isReady(unsigned long version) {
+
+        return this->version == version && size > 0;
+    }
+
+    std::vector<int> NextHopTable::getPath(int source, int target) {
+
+        std::vector<int> path;
+        const long row = (long) target * size;
+
+        if (distances[row + source] == IntegerGraph::INFINITY_WEIGHT)
+            return path;
+
+        for (int v = source; v != -1; v = next_hop[row + v]) {
+            path.push_back(v);
+        }
+        return path;
+    }
+
+    float NextHopTable::getDistance(int source, int target) {
+
+        unsigned int distance = distances[(long) target * size + source];
+        if (distance == IntegerGraph::INFINITY_WEIGHT)
+            return Dijkstra::INFINITY_DISTANCE;
+
+        return distance / INTEGER_GRAPH_SCALE;
+    }
+
+    long NextHopTable::getMemory() {
+
+        return next_hop.size() * sizeof(int) + distances.size() * sizeof(unsigned int);
+    }
+}
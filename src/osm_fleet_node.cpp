@@ -0,0 +1,93 @@
+/*
+ * osm_fleet_node.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: michal
+ */
+
+#include <osm_planner/osm_planner.h>
+#include <nav_msgs/Odometry.h>
+
+//Robots of fleet in one process, every robot has own Planner and Localization in namespace ~/<robot>.
+//The first robot parses the map and publishes the graph to shared memory, the other ones attach it,
+//so the graph is in the memory only once.
+class FleetRobot: osm_planner::Planner{
+public:
+
+    FleetRobot(std::string name) : osm_planner::Planner(name){
+
+        odom_sub = n.subscribe("odom", 1, &FleetRobot::odometryCallback, this);
+        plan_service = n.advertiseService("make_plan", &FleetRobot::makePlanCallback, this);
+    }
+
+private:
+
+    /* Subscribers */
+    ros::Subscriber odom_sub;
+
+    /* Services */
+    ros::ServiceServer plan_service;
+
+    bool makePlanCallback(osm_planner::newTarget::Request &req, osm_planner::newTarget::Response &res) {
+
+        res.result = makePlan(req.latitude, req.longitude);
+        return true;
+    }
+
+    void odometryCallback(const nav_msgs::Odometry::ConstPtr& msg) {
+
+        boost::mutex::scoped_lock lock(*localization.getPositionMutex());
+        localization.setPositionFromOdom(msg->pose.pose.position);
+    }
+};
+
+int main(int argc, char **argv) {
+
+    ros::init(argc, argv, "osm_fleet");
+    ros::NodeHandle n("~");
+
+    std::vector<std::string> robots;
+    n.getParam("robots", robots);
+    if (robots.empty()) {
+        ROS_ERROR("OSM planner: Param robots is empty, there is nothing to plan");
+        return 1;
+    }
+
+    std::string shared_graph;
+    int threads;
+    n.param<std::string>("shared_graph", shared_graph, "osm_fleet_graph");
+    n.param<int>("threads", threads, 0);
+
+    //common params in ~/Planner are copied to every robot, robot's own params in ~/<robot> have priority
+    XmlRpc::XmlRpcValue common;
+    if (n.getParam("Planner", common) && common.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+        ROS_WARN("OSM planner: Param Planner isn't dictionary, it isn't copied to robots");
+        common = XmlRpc::XmlRpcValue();
+    }
+
+    std::vector<boost::shared_ptr<FleetRobot> > fleet;
+    for (int i = 0; i < robots.size(); i++) {
+
+        if (common.getType() == XmlRpc::XmlRpcValue::TypeStruct) {
+            for (XmlRpc::XmlRpcValue::iterator param = common.begin(); param != common.end(); param++) {
+                if (!n.hasParam(robots[i] + "/" + param->first))
+                    n.setParam(robots[i] + "/" + param->first, param->second);
+            }
+        }
+
+        //robots are created in order, so the graph of the first one is ready before the others attach it
+        n.setParam(robots[i] + "/shared_graph", shared_graph);
+        n.setParam(robots[i] + "/shared_graph_mode", std::string(i == 0 ? "publish" : "attach"));
+
+        fleet.push_back(boost::shared_ptr<FleetRobot>(new FleetRobot(robots[i])));
+        ROS_INFO("OSM planner: Robot %s is ready", robots[i].c_str());
+    }
+
+    ROS_INFO("OSM planner: Fleet of %d robots shares graph %s", (int) fleet.size(), shared_graph.c_str());
+
+    //callbacks of all robots, 0 - thread per core
+    ros::MultiThreadedSpinner spinner(threads);
+    spinner.spin();
+
+    return 0;
+}
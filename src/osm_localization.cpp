@@ -2,18 +2,30 @@
 // Created by michal on 30.12.2016.
 //
 #include <osm_planner/osm_localization.h>
+#include <osm_planner/distance_field.h>
 
 
 
 namespace osm_planner {
 
 
-    Localization::Localization(osm_planner::Parser *map) : tfHandler(map->getCalculator()), pathFollower(map, &tfHandler) {
+    Localization::Localization(osm_planner::Parser *map) : Localization(map, "~/Planner") {
+    }
+
+    Localization::Localization(osm_planner::Parser *map, std::string ns) : tfHandler(map->getCalculator()), pathFollower(map, &tfHandler), mapMatcher(map) {
 
         this->map = map;
+        this->ns = ns;
+        tiles = NULL;
+        callback_queue = NULL;
         initialized_position = false;
         initialized_ros = false;
-
+        tracking_max_distance = 0;
+        tracking_version = 0;
+        use_map_matching = false;
+        gps_last_cov = 100000;
+        tf_corrected = false;
+        bearing_first_point_added = false;
     }
 
     Localization::POINT *Localization::getCurrentPosition(){
@@ -26,6 +38,11 @@ namespace osm_planner {
         return &tfHandler;
     }
 
+    boost::mutex *Localization::getPositionMutex(){
+
+        return &position_mutex;
+    }
+
     double Localization::getFootwayWidth(){
 
         return footway_width;
@@ -40,7 +57,9 @@ namespace osm_planner {
 
         if (!initialized_ros) {
             //init ros topics and services
-            ros::NodeHandle n("~/Planner");
+            ros::NodeHandle n(ns);
+            if (callback_queue)
+                n.setCallbackQueue(callback_queue);
 
             //Set the density of points
             n.param<double>("interpolation_max_distance", interpolation_max_distance, 1000);
@@ -56,10 +75,32 @@ namespace osm_planner {
             n.param<std::string>("local_map_frame", local_map_frame, "/rotated_map");
             n.param<std::string>("robot_base_frame", base_link_frame, "/base_link");
             tfHandler.setFrames(map_frame, local_map_frame, base_link_frame);
+            tfHandler.initListener();
 
             n.param<int>("update_tf_pose_from_gps", update_tf_pose_from_gps, 0);
             n.param<double>("footway_width", footway_width, 0);
 
+            //raster of distances to ways for checkDistance(), 0 resolution - disabled
+            double distance_field_resolution, distance_field_margin;
+            int distance_field_max_cells;
+            n.param<double>("distance_field_resolution", distance_field_resolution, 0.5);
+            n.param<double>("distance_field_margin", distance_field_margin, 50.0);
+            n.param<int>("distance_field_max_cells", distance_field_max_cells, 4000000);
+            map->setDistanceField(distance_field_resolution, distance_field_margin, distance_field_max_cells);
+            n.param<double>("tracking_max_distance", tracking_max_distance, 10.0);
+
+            //map matching of gps - noise sigma [m] is used for fixes without covariance
+            double sigma, beta, radius, budget;
+            int candidates, window;
+            n.param<bool>("use_map_matching", use_map_matching, false);
+            n.param<double>("map_matching_sigma", sigma, 5.0);
+            n.param<double>("map_matching_beta", beta, 2.0);
+            n.param<double>("map_matching_radius", radius, 25.0);
+            n.param<int>("map_matching_candidates", candidates, 8);
+            n.param<int>("map_matching_window", window, 10);
+            n.param<double>("map_matching_budget", budget, 0.002);
+            mapMatcher.setParams(sigma, beta, radius, candidates, window, budget);
+
             double distance_for_update_rotation = 5.0;
             n.param<double>("distance_for_update_rotation", distance_for_update_rotation, 5.0);
             n.param<int>("matching_tf_with_map", matching_tf_with_map, 0);
@@ -87,6 +128,17 @@ namespace osm_planner {
             n.param<bool>("use_tf_broadcaster", use_tf, true);
 
 
+            //on_change - static transform after every correction, periodic - 50 Hz
+            std::string tf_broadcast_mode;
+            double tf_keepalive_period;
+            n.param<std::string>("tf_broadcast_mode", tf_broadcast_mode, "periodic");
+            n.param<double>("tf_keepalive_period", tf_keepalive_period, 1.0);
+            if (tf_broadcast_mode != "periodic" && tf_broadcast_mode != "on_change") {
+                ROS_WARN("OSM planner: Unknown tf broadcast mode %s, periodic is used", tf_broadcast_mode.c_str());
+                tf_broadcast_mode = "periodic";
+            }
+            tfHandler.setBroadcastMode(tf_broadcast_mode == "on_change", tf_keepalive_period);
+
             if (use_tf) {
                 system("rosnode kill /move_base/osm_helper");
                 tfHandler.initThread();
@@ -97,6 +149,16 @@ namespace osm_planner {
         }
 
     }
+
+    void Localization::setCallbackQueue(ros::CallbackQueueInterface *queue) {
+
+        callback_queue = queue;
+    }
+
+    void Localization::setTileCache(TileCache *tiles) {
+
+        this->tiles = tiles;
+    }
     //-------------------------------------------------------------//
     //---------------Initialize pose from gps source---------------//
     //-------------------------------------------------------------//
@@ -115,9 +177,13 @@ namespace osm_planner {
         if (initialized_position)
             return;
 
-        map->parse();
+        if (tiles)
+            tiles->setPosition(lat, lon, true);
+        else
+            map->parse();
 
         map->getCalculator()->setOrigin(lat, lon);
+        map->buildDistanceField();
 
         //Save the position for path planning
         source.geoPoint.latitude = lat;
@@ -150,7 +216,12 @@ namespace osm_planner {
         if (initialized_position)
             return;
 
-        map->parse();
+        if (tiles) {
+            Parser::OSM_NODE center = tiles->getFirstTileCenter();
+            tiles->setPosition(center.latitude, center.longitude, true);
+        } else
+            map->parse();
+
         if (random){
         map->setStartPoint();
             source.geoPoint = map->getCalculator()->getOrigin();
@@ -170,6 +241,7 @@ namespace osm_planner {
 
             source.geoPoint = origin;
         }
+        map->buildDistanceField();
 
         //Save the position for path planning
         source.id = 0;
@@ -201,8 +273,20 @@ namespace osm_planner {
         if (!initialized_position)
             return false;
 
-        //update source point
-        source.id = map->getNearestPoint(msg->latitude, msg->longitude);
+        if (tiles)
+            tiles->setPosition(msg->latitude, msg->longitude);
+
+        //update source point - edge matched by HMM or the nearest node
+        MapMatcher::MATCH match;
+        double sigma = 0;
+        if (msg->position_covariance_type != sensor_msgs::NavSatFix::COVARIANCE_TYPE_UNKNOWN)
+            sigma = sqrt(std::max(msg->position_covariance[0], msg->position_covariance[4]));
+
+        if (use_map_matching && mapMatcher.addFix(msg->latitude, msg->longitude, sigma, &match))
+            source.id = match.node;
+        else
+            trackSource(msg->latitude, msg->longitude);
+
         source.geoPoint.latitude = msg->latitude;
         source.geoPoint.longitude = msg->longitude;
         source.cartesianPoint.pose.position.x = map->getCalculator()->getCoordinateX(source.geoPoint);
@@ -234,12 +318,11 @@ namespace osm_planner {
                 break;
 
             case ENABLED_ONE:
-                static double last_cov = 100000;
 
-                if (cov <= last_cov){
+                if (cov <= gps_last_cov){
 
                     tfHandler.improveTfPoseFromGPS(msg);
-                    last_cov = cov;
+                    gps_last_cov = cov;
                 }
 
                 break;
@@ -255,11 +338,9 @@ namespace osm_planner {
 
         if (matching_tf_with_map){
 
-            static bool isCorrection = false;
-
-            if (isCorrection != true || matching_tf_with_map == ENABLED_ALLWAYS) {
-                pathFollower.addPoint(msg);
-                isCorrection = pathFollower.doCorrection();
+            if (tf_corrected != true || matching_tf_with_map == ENABLED_ALLWAYS) {
+                pathFollower.addPoint(msg, source.id);
+                tf_corrected = pathFollower.doCorrection();
             }
         }
 
@@ -271,8 +352,12 @@ namespace osm_planner {
             return;
         }
 
+        Parser::OSM_NODE position = map->getCalculator()->getGeoPoint(point.x, point.y);
+        if (tiles)
+            tiles->setPosition(position.latitude, position.longitude);
+
         //update source point
-        source.id = map->getNearestPointXY(point.x, point.y);
+        trackSource(position.latitude, position.longitude);
         source.cartesianPoint.pose.position = point;
         // osm.publishPoint(point, Parser::CURRENT_POSITION_MARKER, 5.0);
 
@@ -283,6 +368,16 @@ namespace osm_planner {
     }
 
 
+    void Localization::trackSource(double lat, double lon) {
+
+        //IDs of nodes can be changed by new graph
+        unsigned long version = map->getGraphVersion();
+        int previous_id = version == tracking_version ? source.id : -1;
+        tracking_version = version;
+
+        source.id = map->trackNearestPoint(previous_id, lat, lon, tracking_max_distance);
+    }
+
     double Localization::getAccuracy(const sensor_msgs::NavSatFix::ConstPtr& gps){
 
         double sum = 0;
@@ -294,12 +389,16 @@ namespace osm_planner {
 
     double Localization::checkDistance(int node_id, double lat, double lon) {
 
-        Parser::OSM_NODE node1 = map->getNodeByID(node_id);
         Parser::OSM_NODE node2;
         node2.latitude = lat;
         node2.longitude = lon;
 
-        double dist = Parser::Haversine::getDistance(node1, node2) - footway_width;
+        double dist = getFieldDistance(map->getCalculator()->getCoordinateX(node2), map->getCalculator()->getCoordinateY(node2));
+        if (dist < 0) {
+            Parser::OSM_NODE node1 = map->getNodeByID(node_id);
+            dist = Parser::Haversine::getDistance(node1, node2);
+        }
+        dist -= footway_width;
 
         if (dist > interpolation_max_distance) {
             ROS_WARN("OSM planner: The coordinates is %f m out of the way", dist);
@@ -310,13 +409,15 @@ namespace osm_planner {
 
     double Localization::checkDistance(int node_id, geometry_msgs::Pose pose) {
 
-        Parser::OSM_NODE node = map->getNodeByID(node_id);
-
-
-        double x = map->getCalculator()->getCoordinateX(node);
-        double y = map->getCalculator()->getCoordinateY(node);
+        double dist = getFieldDistance(pose.position.x, pose.position.y);
+        if (dist < 0) {
+            Parser::OSM_NODE node = map->getNodeByID(node_id);
 
-        double dist = sqrt(pow(x - pose.position.x, 2.0) + pow(y - pose.position.y, 2.0)) - footway_width;
+            double x = map->getCalculator()->getCoordinateX(node);
+            double y = map->getCalculator()->getCoordinateY(node);
+            dist = sqrt(pow(x - pose.position.x, 2.0) + pow(y - pose.position.y, 2.0));
+        }
+        dist -= footway_width;
 
         if (dist > interpolation_max_distance) {
             ROS_WARN("OSM planner: The coordinates is %f m out of the way", dist);
@@ -325,12 +426,22 @@ namespace osm_planner {
         return dist;
     }
 
+    double Localization::getFieldDistance(double x, double y) {
+
+        boost::shared_ptr<const DistanceField> field = map->getDistanceField();
+        if (!field)
+            return -1;
+        return field->getDistance(x, y);
+    }
+
     //=========================================//
     //================== Callbacks ============//
     //=========================================//
 
    bool Localization::initCallback(osm_planner::newTarget::Request &req, osm_planner::newTarget::Response &res){
 
+        boost::mutex::scoped_lock lock(position_mutex);
+
         //if longitude and latitude are incorrect then get initalize pose from gps topic
         if (req.longitude <= 0 && req.latitude <= 0 ) initFromGpsCallback = true;
         else initializePos(req.latitude, req.longitude);
@@ -349,24 +460,21 @@ namespace osm_planner {
         if (!isInitialized())
             return true;
 
-        static osm_planner::Parser::OSM_NODE firstPoint;
-        static bool firstPointAdded = false;
-
-        if (!firstPointAdded){
-            firstPoint.longitude = req.longitude;
-            firstPoint.latitude = req.latitude;
+        if (!bearing_first_point_added){
+            bearing_first_point.longitude = req.longitude;
+            bearing_first_point.latitude = req.latitude;
             res.message = "Added first point, please move robot forward and call service again";
             res.bearing = 0;
-            firstPointAdded  = true;
+            bearing_first_point_added  = true;
             return true;
         } else{
 
             osm_planner::Parser::OSM_NODE secondPoint;
             secondPoint.longitude = req.longitude;
             secondPoint.latitude = req.latitude;
-            double angle = osm_planner::Parser::Haversine::getBearing(firstPoint, secondPoint);
+            double angle = osm_planner::Parser::Haversine::getBearing(bearing_first_point, secondPoint);
             res.message = "Bearing was calculated";
-            firstPointAdded = false;
+            bearing_first_point_added = false;
             tfHandler.setTfRotation(angle);
             res.bearing = angle;
             return true;
@@ -379,6 +487,8 @@ namespace osm_planner {
         if (msg->status.status == sensor_msgs::NavSatStatus::STATUS_NO_FIX)
             return;
 
+        boost::mutex::scoped_lock lock(position_mutex);
+
         //If is request for initiliaze pose from gps callback
         if (initFromGpsCallback) {
 
@@ -414,6 +524,14 @@ namespace osm_planner {
     TfHandler::TfHandler(osm_planner::Parser::Haversine *calculator) {
 
         this->calculator = calculator;
+        broadcast_on_change = false;
+        keepalive_period = 0;
+    }
+
+    void TfHandler::setBroadcastMode(bool on_change, double keepalive_period) {
+
+        this->broadcast_on_change = on_change;
+        this->keepalive_period = keepalive_period;
     }
 
     void TfHandler::setFrames(std::string map_frame, std::string local_map_frame, std::string base_link_frame) {
@@ -431,35 +549,48 @@ namespace osm_planner {
 
     }
 
+    void TfHandler::initListener(){
+
+        boost::mutex::scoped_lock lock(listener_mutex);
+        if (tf_listener)
+            return;
+
+        tf_buffer.reset(new tf2_ros::Buffer());
+        tf_listener.reset(new tf2_ros::TransformListener(*tf_buffer, true));
+    }
+
     geometry_msgs::Point TfHandler::getPoseFromTF(std::string map_link) {
 
+        initListener();
 
         geometry_msgs::Point point;
-        tf::TransformListener listener;
-        tf::StampedTransform transform;
 
         try {
-        //    listener.waitForTransform(base_link_frame, map_link, ros::Time(0), ros::Duration(0.5));
-           // listener.lookupTransform(base_link_frame, map_link, ros::Time(0), transform);
-
-            listener.waitForTransform(map_link, base_link_frame, ros::Time(0), ros::Duration(1));
-            listener.lookupTransform(map_link, base_link_frame, ros::Time(0), transform);
-
-            ROS_WARN("get transfrom %s", map_link.c_str());
-        } catch (tf::TransformException ex) {
-            ROS_WARN("OSM planner: %s. Can't update pose from TF %s", ex.what(), map_link.c_str());
+            //the latest transform in the buffer, it doesn't wait for new one
+            geometry_msgs::TransformStamped transform = tf_buffer->lookupTransform(getTf2Frame(map_link), getTf2Frame(base_link_frame), ros::Time(0));
+            point.x = transform.transform.translation.x;
+            point.y = transform.transform.translation.y;
+            point.z = transform.transform.translation.z;
+
+            boost::mutex::scoped_lock lock(listener_mutex);
+            last_poses[map_link] = point;
+
+        } catch (tf2::TransformException &ex) {
+
+            boost::mutex::scoped_lock lock(listener_mutex);
+            std::map<std::string, geometry_msgs::Point>::iterator last = last_poses.find(map_link);
+            if (last != last_poses.end()) {
+                ROS_WARN_THROTTLE(5, "OSM planner: %s. The last known pose from TF %s is used", ex.what(), map_link.c_str());
+                return last->second;
+            }
+            ROS_WARN_THROTTLE(5, "OSM planner: %s. Can't update pose from TF %s", ex.what(), map_link.c_str());
         }
 
-        tf::pointTFToMsg(transform.getOrigin(), point);
-
         return point;
     }
 
     void TfHandler::improveTfPoseFromGPS(const sensor_msgs::NavSatFix::ConstPtr& gps){
 
-        static double diff_x = 0;
-        static double diff_y = 0;
-
         geometry_msgs::Point positionFromTF = getPoseFromTF(getMapFrame());
 
         double tf_x = positionFromTF.x;
@@ -468,64 +599,89 @@ namespace osm_planner {
         double gps_x = calculator->getCoordinateX(*gps);
         double gps_y = calculator->getCoordinateY(*gps);
 
-        diff_x += gps_x - tf_x;
-        diff_y += gps_y - tf_y;
+        boost::mutex::scoped_lock lock(writer_mutex);
+        TF_STATE state = tf_state.load();
+        state.x += gps_x - tf_x;
+        state.y += gps_y - tf_y;
+        tf_state.store(state);
 
     //    ROS_INFO("TF pose : x %f y %f", tf_x, tf_y);
      //   ROS_INFO("GPS pose: x %f y %f", gps_x, gps_y);
-      //  ROS_INFO("improve tf pose from gps x:%f y:%f", diff_x, diff_y);
-
-        broadcaster_mutex.lock();
-        transform.setOrigin(tf::Vector3(diff_x, diff_y, 0));
-        broadcaster_mutex.unlock();
+      //  ROS_INFO("improve tf pose from gps x:%f y:%f", state.x, state.y);
     }
 
     void TfHandler::setTfRotation(double angle) {
 
-        yaw = angle;
-        tf::Quaternion q;
-        q.setRPY(0, 0, yaw);
-        broadcaster_mutex.lock();
-        transform.setRotation(q);
-        broadcaster_mutex.unlock();
+        boost::mutex::scoped_lock lock(writer_mutex);
+        TF_STATE state = tf_state.load();
+        state.yaw = angle;
+        tf_state.store(state);
     }
 
 
     void TfHandler::improveTfRotation(double angleDiff) {
 
-        yaw += angleDiff;
-     //   ROS_ERROR("yaw %f", yaw);
-        tf::Quaternion q;
-        q.setRPY(0, 0,  yaw);
-        broadcaster_mutex.lock();
-        transform.setRotation(q);
-        broadcaster_mutex.unlock();
+        boost::mutex::scoped_lock lock(writer_mutex);
+        TF_STATE state = tf_state.load();
+        state.yaw += angleDiff;
+     //   ROS_ERROR("yaw %f", state.yaw);
+        tf_state.store(state);
     }
 
     void TfHandler::tfBroadcaster(){
 
-        //inicialize TF broadcaster
-        transform.setOrigin( tf::Vector3(0.0, 0.0, 0.0) );
-        tf::Quaternion q;
-        q.setRPY(0, 0, 0);
-        transform.setRotation(q);
-
      //   std::string rotated_frame = local_map_frame + "_rotated";
 
         ros::Rate rate(50);
 
+        //version of the last sent static transform, versions of stored values are even
+        unsigned long sent_version = 1;
+        ros::Time sent_time;
+
         while (ros::ok()){
-            broadcaster_mutex.lock();
-            br.sendTransform(tf::StampedTransform(transform, ros::Time::now(), map_frame, local_map_frame));
-            broadcaster_mutex.unlock();
+
+            unsigned long version;
+            TF_STATE state = tf_state.load(&version);
+            ros::Time now = ros::Time::now();
+
+            if (!broadcast_on_change) {
+                br.sendTransform(createTransform(state, now));
+
+            } else if (version != sent_version || (keepalive_period > 0 && (now - sent_time).toSec() >= keepalive_period)) {
+                //latched, so the new subscribers get it too
+                static_br.sendTransform(createTransform(state, now));
+                sent_version = version;
+                sent_time = now;
+            }
+
             rate.sleep();
         }
     }
 
+    geometry_msgs::TransformStamped TfHandler::createTransform(const TF_STATE &state, ros::Time stamp) {
+
+        geometry_msgs::TransformStamped transform;
+        transform.header.stamp = stamp;
+        transform.header.frame_id = getTf2Frame(map_frame);
+        transform.child_frame_id = getTf2Frame(local_map_frame);
+        transform.transform.translation.x = state.x;
+        transform.transform.translation.y = state.y;
+        transform.transform.translation.z = 0;
+        transform.transform.rotation = tf::createQuaternionMsgFromYaw(state.yaw);
+        return transform;
+    }
+
     std::string TfHandler::getMapFrame(){ return map_frame; }
     std::string TfHandler::getBaseLinkFrame(){ return base_link_frame; }
     std::string TfHandler::getLocalMapFrame(){ return local_map_frame; }
 
+    std::string TfHandler::getTf2Frame(std::string frame) {
+
+        if (!frame.empty() && frame[0] == '/')
+            return frame.substr(1);
+        return frame;
+    }
+
 
     //-----------------------------------]
     //-------PATH FOLLOWER---------------]
@@ -537,7 +693,9 @@ namespace osm_planner {
         this->tf = tf;
         firstNodeAdded = false;
         secondNodeAdded = false;
+        lastNodeID = -1;
         angleDiff = 0;
+        angleOnStart = 0;
         currentDistance = 0;
     }
 
@@ -546,15 +704,13 @@ namespace osm_planner {
         this->maxDistance = maxDistance;
     }
 
-    void PathFollower::addPoint(const sensor_msgs::NavSatFix::ConstPtr& gps) {
-
-        static int lastNodeID;
+    void PathFollower::addPoint(const sensor_msgs::NavSatFix::ConstPtr& gps, int nodeID) {
 
       //  this->currentPosition = tf->getPoseFromTF(tf->getMapFrame());
        // this->currentNodeID = map->getNearestPointXY(currentPosition.x, currentPosition.y);
         currentPosition.node.latitude = gps->latitude;
         currentPosition.node.longitude = gps->longitude;
-        currentPosition.id = map->getNearestPoint(gps->latitude, gps->longitude);
+        currentPosition.id = nodeID;
 
         if (!firstNodeAdded){
 
@@ -583,8 +739,6 @@ namespace osm_planner {
 
     void PathFollower::calculate() {
 
-        static double angleOnStart = 0;
-
         //calculate angle between current node and first node
         //double pathAngle = map->getCalculator()->getBearing(map->getNodeByID(firstNodeID), map->getNodeByID(currentNodeID));
         //double pathDist = map->getCalculator()->getDistance(map->getNodeByID(firstNodeID), map->getNodeByID(currentNodeID));
@@ -4,22 +4,62 @@
 
 
 #include <osm_planner/osm_parser.h>
+#include <osm_planner/distance_field.h>
 namespace osm_planner {
 
+    //bits of tags are pushed to vectors by reference
+    const int Parser::TAG_ANY;
+    const int Parser::TAG_HIGHWAY;
+    const int Parser::TAG_VALUES;
 
-    Parser::Parser() {
+    const int Parser::SHARED_GRAPH_NONE;
+    const int Parser::SHARED_GRAPH_PUBLISH;
+    const int Parser::SHARED_GRAPH_ATTACH;
+
+
+    Parser::Parser() : ns("~/Planner"), graph_version(0), grid_outdated(false) {
+
+        crop.type = NO_CROP;
+        shared_graph_mode = SHARED_GRAPH_NONE;
 
       initialize();
     }
 
-    Parser::Parser(std::string file) : xml(file) {
+    Parser::Parser(std::string file) : xml(file), ns("~/Planner"), graph_version(0), grid_outdated(false) {
+
+        crop.type = NO_CROP;
+        shared_graph_mode = SHARED_GRAPH_NONE;
+        initialize();
+    }
+
+    Parser::Parser(std::string file, std::string ns) : xml(file), ns(ns), graph_version(0), grid_outdated(false) {
 
+        crop.type = NO_CROP;
+        shared_graph_mode = SHARED_GRAPH_NONE;
         initialize();
     }
 
+    Parser::~Parser() {
+
+        if (distance_field_thread)
+            distance_field_thread->join();
+    }
+
    void Parser::initialize(){
 
-        ros::NodeHandle n("~/Planner");
+        //empty map until the first parsing
+        graph = boost::shared_ptr<GRAPH>(new GRAPH());
+        graph->version = 0;
+        graph->structure_version = 0;
+
+        ros::NodeHandle n(ns);
+        visualization_queue = NULL;
+
+        distance_field_resolution = 0;
+        distance_field_margin = 0;
+        distance_field_max_cells = 0;
+        distance_field_building = false;
+        distance_field_outdated = false;
 
         //get the parameters
         n.param<std::string>("global_frame", map_frame, "/world");
@@ -38,6 +78,19 @@ namespace osm_planner {
 
     void Parser::parse(bool onlyFirstElement) {
 
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
+
+        //graph is compiled by other process
+        if (shared_graph_mode == SHARED_GRAPH_ATTACH) {
+            while (!attachSharedGraph()) {
+                if (!ros::ok())
+                    throw std::runtime_error("Shared graph isn't available");
+                ROS_WARN_THROTTLE(5, "OSM planner: Waiting for shared graph %s...", shared_graph_name.c_str());
+                ros::Duration(0.5).sleep();
+            }
+            return;
+        }
+
         ros::Time start_time = ros::Time::now();
         TiXmlDocument doc(xml);
         TiXmlNode *osm;
@@ -56,6 +109,10 @@ namespace osm_planner {
         }
 
         osm = doc.FirstChildElement();
+        if (!osm || !osm->FirstChild("node") || !osm->FirstChild("way")) {
+            ROS_ERROR("OSM planner: Map %s doesn't contain nodes or ways", xml.c_str());
+            throw std::runtime_error("Map without nodes or ways");
+        }
         node = osm->FirstChild("node");
         way = osm->FirstChild("way");
         TiXmlElement *nodeElement = node->ToElement();
@@ -66,12 +123,91 @@ namespace osm_planner {
         hRootWay = TiXmlHandle(wayElement);
 
 
-        createWays(&hRootWay, &hRootNode, types_of_ways, onlyFirstElement);
-        createNodes(&hRootNode, onlyFirstElement);
+        //xml is read only once, graphs for other filters are built from the store
+        store = createStore(&hRootWay, &hRootNode);
+
+        //new snapshot is built aside, the current one still serves searches
+        boost::shared_ptr<GRAPH> new_graph = createGraph(store, types_of_ways, onlyFirstElement);
+        if (shared_graph_mode == SHARED_GRAPH_PUBLISH && !onlyFirstElement)
+            publishSharedGraph(new_graph.get());
+
+        //only pointers are swapped, the old snapshot is released by the last search, which uses it
+        {
+            boost::mutex::scoped_lock lock(graph_pointer_mutex);
+            graph.swap(new_graph);
+        }
+        updateDistanceField();
+
+        ROS_INFO("OSM planner: Map was parsed, %d nodes, %d of %d ways, %d tags, time: %f", (int) graph->nodes.size(), (int) graph->ways.size(),
+                 (int) store->way_ids.size(), (int) store->values.size(), (ros::Time::now() - start_time).toSec());
+    }
+
+    void Parser::filterWays(std::vector<std::string> types) {
+
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
 
-        if (onlyFirstElement) return;
+        if (shared_graph_mode == SHARED_GRAPH_ATTACH) {
+            ROS_ERROR("OSM planner: Graph is attached from shared memory, ways can be filtered only by its publisher");
+            throw std::runtime_error("Shared graph is attached");
+        }
+
+        if (!store) {
+            ROS_ERROR("OSM planner: Map isn't parsed, ways can't be filtered");
+            throw std::runtime_error("Map isn't parsed");
+        }
+
+        ros::Time start_time = ros::Time::now();
+        boost::shared_ptr<GRAPH> new_graph = createGraph(store, types);
+        types_of_ways = types;
+        if (shared_graph_mode == SHARED_GRAPH_PUBLISH)
+            publishSharedGraph(new_graph.get());
+
+        {
+            boost::mutex::scoped_lock lock(graph_pointer_mutex);
+            graph.swap(new_graph);
+        }
+        updateDistanceField();
 
-        createNetwork();
+        ROS_INFO("OSM planner: Ways were filtered, %d nodes, %d ways, time: %f", (int) graph->nodes.size(), (int) graph->ways.size(),
+                 (ros::Time::now() - start_time).toSec());
+    }
+
+    Parser::GraphLock::GraphLock(Parser *parser) : parser(parser), pinned(false) {
+
+        pin(parser->getGraph());
+    }
+
+    Parser::GraphLock::GraphLock(Parser *parser, boost::shared_ptr<GRAPH> graph) : parser(parser), pinned(false) {
+
+        pin(graph ? graph : parser->getGraph());
+    }
+
+    void Parser::GraphLock::pin(boost::shared_ptr<GRAPH> graph) {
+
+        //nested lock uses the snapshot, which is already locked
+        if (parser->locked_graph.get())
+            return;
+
+        this->graph = graph;
+        lock = boost::shared_lock<boost::shared_mutex>(graph->mutex);
+        parser->locked_graph.reset(new boost::shared_ptr<GRAPH>(graph));
+        pinned = true;
+    }
+
+    Parser::GraphLock::~GraphLock() {
+
+        unlock();
+    }
+
+    void Parser::GraphLock::unlock() {
+
+        if (!pinned)
+            return;
+
+        parser->locked_graph.reset();
+        lock.unlock();
+        graph.reset();
+        pinned = false;
     }
 
     void Parser::publishPoint(geometry_msgs::Point point, int marker_type, double radius, geometry_msgs::Quaternion orientation) {
@@ -125,8 +261,10 @@ namespace osm_planner {
         point.x = 0;
         point.y = 0;
 
-        point.x = haversine.getCoordinateX(nodes[pointID]);
-        point.y = haversine.getCoordinateY(nodes[pointID]);
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        point.x = haversine.getCoordinateX(graph->nodes[pointID]);
+        point.y = haversine.getCoordinateY(graph->nodes[pointID]);
 
         publishPoint(point, marker_type, radius, orientation);
 
@@ -143,20 +281,45 @@ namespace osm_planner {
         pose.pose.position.y = 0;
         pose.pose.position.z = 0;
 
-        for (int i = 0; i < ways.size(); i++) {
-            path.poses.clear();
+        //paths are computed under the lock, the slow publishing doesn't block updates of graph
+        std::vector<nav_msgs::Path> paths;
+        {
+            GraphLock graph_lock(this);
+            boost::shared_ptr<GRAPH> graph = getGraph();
+            const std::vector<OSM_WAY> &ways = graph->ways;
+            const NodeStore<OSM_NODE> &nodes = graph->nodes;
 
-            for (int j = 0; j < ways[i].nodesId.size(); j++) {
+            paths.resize(ways.size(), path);
+            for (int i = 0; i < ways.size(); i++) {
 
-                pose.pose.position.x = haversine.getCoordinateX(nodes[ways[i].nodesId[j]]);
-                pose.pose.position.y = haversine.getCoordinateY(nodes[ways[i].nodesId[j]]);
-                path.poses.push_back(pose);
+                for (int j = 0; j < ways[i].nodesId.size(); j++) {
 
+                    pose.pose.position.x = haversine.getCoordinateX(nodes[ways[i].nodesId[j]]);
+                    pose.pose.position.y = haversine.getCoordinateY(nodes[ways[i].nodesId[j]]);
+                    paths[i].poses.push_back(pose);
+
+                }
             }
+        }
+
+        if (visualization_queue)
+            Executor::post(visualization_queue, boost::bind(&Parser::publishPaths, this, paths));
+        else
+            publishPaths(paths);
+    }
+
+    void Parser::setVisualizationQueue(ros::CallbackQueueInterface *queue) {
+
+        visualization_queue = queue;
+    }
+
+    void Parser::publishPaths(std::vector<nav_msgs::Path> paths) {
+
+        for (int i = 0; i < paths.size(); i++) {
             usleep(10000);
 
-            path.header.stamp = ros::Time::now();
-            path_pub.publish(path);
+            paths[i].header.stamp = ros::Time::now();
+            path_pub.publish(paths[i]);
         }
     }
 
@@ -172,10 +335,12 @@ namespace osm_planner {
         pose.pose.position.y = 0;
         pose.pose.position.z = 0;
 
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
         for (int i = 0; i < nodesInPath.size(); i++) {
 
-            pose.pose.position.x = haversine.getCoordinateX(nodes[nodesInPath[i]]);
-            pose.pose.position.y = haversine.getCoordinateY(nodes[nodesInPath[i]]);
+            pose.pose.position.x = haversine.getCoordinateX(graph->nodes[nodesInPath[i]]);
+            pose.pose.position.y = haversine.getCoordinateY(graph->nodes[nodesInPath[i]]);
             refused_path.poses.push_back(pose);
         }
 
@@ -185,9 +350,219 @@ namespace osm_planner {
 
     void Parser::deleteEdgeOnGraph(int nodeID_1, int nodeID_2) {
 
-        networkArray[nodeID_1][nodeID_2] = 0;
-        networkArray[nodeID_2][nodeID_1] = 0;
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        boost::unique_lock<boost::shared_mutex> lock(graph->mutex);
+
+        //IDs from the previous map after reload
+        int size = graph->integer_graph.size();
+        if (nodeID_1 < 0 || nodeID_1 >= size || nodeID_2 < 0 || nodeID_2 >= size)
+            return;
+
+        //shared graph has no matrix, its adjacency lists are copied by the first change
+        if (!graph->networkArray.empty()) {
+            graph->networkArray[nodeID_1][nodeID_2] = 0;
+            graph->networkArray[nodeID_2][nodeID_1] = 0;
+        }
+        graph->integer_graph.deleteEdge(nodeID_1, nodeID_2);
+        graph->integer_graph.deleteEdge(nodeID_2, nodeID_1);
+        graph->version = ++graph_version;
+
+    }
+
+    //-------------------------------------------------------------//
+    //--------------Incremental update from OsmChange--------------//
+    //-------------------------------------------------------------//
+
+    //cost of update depends on the size of diff, not on the size of map
+    int Parser::applyChange(std::string osc) {
+
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
+
+        if (shared_graph_mode == SHARED_GRAPH_ATTACH) {
+            ROS_ERROR("OSM planner: Graph is attached from shared memory, changes can be applied only by its publisher");
+            throw std::runtime_error("Shared graph is attached");
+        }
+
+        ros::Time start_time = ros::Time::now();
+        TiXmlDocument doc(osc);
+
+        if (!doc.LoadFile()) {
+            ROS_ERROR("OSM planner: Failed to load file %s", osc.c_str());
+            throw std::runtime_error("Failed to load osc");
+        }
+
+        TiXmlElement *root = doc.FirstChildElement("osmChange");
+        if (!root) {
+            ROS_ERROR("OSM planner: File %s isn't OsmChange", osc.c_str());
+            throw std::runtime_error("Failed to load osc");
+        }
+
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        boost::unique_lock<boost::shared_mutex> lock(graph->mutex);
+
+        boost::unordered_set<int> changed_ways;
+        std::vector<int> touched_ways;      //ways with moved nodes
+        std::vector<int> deleted_nodes;
+
+        //nodes first, new ways can use new nodes
+        for (TiXmlElement *action = root->FirstChildElement(); action; action = action->NextSiblingElement()) {
+
+            std::string type(action->Value());
+            for (TiXmlElement *element = action->FirstChildElement("node"); element; element = element->NextSiblingElement("node")) {
+
+                int id;
+                element->Attribute("id", &id);
+
+                //node can be still used by way, which is deleted later in the same diff
+                if (type == "delete") {
+                    deleted_nodes.push_back(id);
+                    continue;
+                }
+
+                OSM_NODE node = {0, 0, 0, 0};
+                element->Attribute("lat", &node.latitude);
+                element->Attribute("lon", &node.longitude);
+
+                //node moved out of crop region is forgotten and its ways are clipped again
+                boost::unordered_map<int, int>::iterator index = graph->node_index.find(id);
+                if (!isInCropRegion(node)) {
+                    removeOsmNode(graph.get(), id);
+                    if (index != graph->node_index.end()) {
+                        const std::vector<int> &ways = graph->node_ways[id];
+                        touched_ways.insert(touched_ways.end(), ways.begin(), ways.end());
+                    }
+                    continue;
+                }
+                setOsmNode(graph.get(), id, node);
+
+                if (index != graph->node_index.end()) {
+                    setGridCell(graph.get(), index->second, false);
+                    graph->nodes.set(index->second, node);
+                    setGridCell(graph.get(), index->second, true);
+
+                    const std::vector<int> &ways = graph->node_ways[id];
+                    touched_ways.insert(touched_ways.end(), ways.begin(), ways.end());
+                }
+            }
+        }
+
+        for (TiXmlElement *action = root->FirstChildElement(); action; action = action->NextSiblingElement()) {
+
+            std::string type(action->Value());
+            for (TiXmlElement *element = action->FirstChildElement("way"); element; element = element->NextSiblingElement("way")) {
+
+                OSM_WAY way;
+                element->Attribute("id", &way.id);
+
+                removeWay(graph.get(), way.id);
+                changed_ways.insert(way.id);
+
+                //modified way can lose the selected tag
+                if (type == "delete" || !isSelectedWay(element))
+                    continue;
+
+                for (TiXmlElement *nd = element->FirstChildElement("nd"); nd; nd = nd->NextSiblingElement("nd")) {
+                    int ref;
+                    nd->Attribute("ref", &ref);
+                    way.refs.push_back(ref);
+                }
+                addWay(graph.get(), way);
+            }
+        }
+
+        //ways with moved nodes get new lengths of edges and new interpolated nodes
+        for (int i = 0; i < touched_ways.size(); i++) {
+
+            if (changed_ways.count(touched_ways[i]))
+                continue;
+
+            std::vector<OSM_WAY> pieces;
+            std::pair<boost::unordered_multimap<int, int>::iterator, boost::unordered_multimap<int, int>::iterator> range = graph->way_index.equal_range(touched_ways[i]);
+            for (boost::unordered_multimap<int, int>::iterator it = range.first; it != range.second; it++) {
+                pieces.push_back(graph->ways[it->second]);
+            }
+            if (pieces.empty())
+                continue;
+
+            removeWay(graph.get(), touched_ways[i]);
+            for (int j = 0; j < pieces.size(); j++) {
+                addWay(graph.get(), pieces[j]);
+            }
+            changed_ways.insert(touched_ways[i]);
+        }
+
+        for (int i = 0; i < deleted_nodes.size(); i++) {
+
+            if (graph->node_ways.count(deleted_nodes[i]))
+                ROS_WARN("OSM planner: Deleted node %d is still used by way", deleted_nodes[i]);
+            else
+                removeOsmNode(graph.get(), deleted_nodes[i]);
+        }
+
+        updateGrid(graph.get());
+        graph->structure_version = graph->version = ++graph_version;
+        updateDistanceField();
+
+        if (shared_graph_mode == SHARED_GRAPH_PUBLISH)
+            publishSharedGraph(graph.get());
+
+        ROS_INFO("OSM planner: Applied change %s, %d ways, %d nodes, time: %f", osc.c_str(), (int) changed_ways.size(),
+                 (int) (graph->nodes.size() - graph->free_nodes.size()), (ros::Time::now() - start_time).toSec());
+
+        return changed_ways.size();
+    }
+
+    //tiles share ways, which cross their borders, the caller loads every way only once
+    void Parser::addWays(const std::vector<OSM_WAY> &ways, const boost::unordered_map<int, OSM_NODE> &nodes) {
+
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        boost::unique_lock<boost::shared_mutex> lock(graph->mutex);
+
+        for (boost::unordered_map<int, OSM_NODE>::const_iterator it = nodes.begin(); it != nodes.end(); it++) {
+            if (isInCropRegion(it->second))
+                setOsmNode(graph.get(), it->first, it->second);
+        }
+
+        for (int i = 0; i < ways.size(); i++) {
+            removeWay(graph.get(), ways[i].id);
+            addWay(graph.get(), ways[i]);
+        }
+
+        //nodes of clipped parts of ways aren't used
+        for (boost::unordered_map<int, OSM_NODE>::const_iterator it = nodes.begin(); it != nodes.end(); it++) {
+            if (!graph->node_ways.count(it->first))
+                removeOsmNode(graph.get(), it->first);
+        }
+
+        updateGrid(graph.get());
+        graph->structure_version = graph->version = ++graph_version;
+        updateDistanceField();
+    }
+
+    //coordinates of nodes, which aren't used by any way, are forgotten
+    void Parser::removeWays(const std::vector<int> &wayIDs) {
+
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        boost::unique_lock<boost::shared_mutex> lock(graph->mutex);
+
+        for (int i = 0; i < wayIDs.size(); i++) {
+
+            std::vector<int> refs;
+            std::pair<boost::unordered_multimap<int, int>::iterator, boost::unordered_multimap<int, int>::iterator> range = graph->way_index.equal_range(wayIDs[i]);
+            for (boost::unordered_multimap<int, int>::iterator it = range.first; it != range.second; it++) {
+                const std::vector<int> &piece = graph->ways[it->second].refs;
+                refs.insert(refs.end(), piece.begin(), piece.end());
+            }
+            removeWay(graph.get(), wayIDs[i]);
+
+            for (int j = 0; j < refs.size(); j++) {
+                if (!graph->node_ways.count(refs[j]))
+                    removeOsmNode(graph.get(), refs[j]);
+            }
+        }
 
+        graph->structure_version = graph->version = ++graph_version;
+        updateDistanceField();
     }
 
     /* GETTERS */
@@ -195,7 +570,31 @@ namespace osm_planner {
 //getter for dijkstra algorithm - getting only pointer for spare memory
     std::vector<std::vector<float> > *Parser::getGraphOfVertex() {
 
-        return &networkArray;
+        return &getGraph()->networkArray;
+    }
+
+    IntegerGraph *Parser::getIntegerGraph() {
+
+        return &getGraph()->integer_graph;
+    }
+
+    boost::shared_ptr<Parser::GRAPH> Parser::getGraph() {
+
+        if (locked_graph.get())
+            return *locked_graph;
+
+        boost::mutex::scoped_lock lock(graph_pointer_mutex);
+        return graph;
+    }
+
+    unsigned long Parser::getGraphVersion() {
+
+        return getGraph()->version;
+    }
+
+    unsigned long Parser::getStructureVersion() {
+
+        return getGraph()->structure_version;
     }
 
     //getting defined path
@@ -215,6 +614,10 @@ namespace osm_planner {
         pose.pose.position.z = 0;
         pose.header.frame_id = map_frame;
 
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+
         for (int i = 0; i < nodesInPath.size(); i++) {
 
             pose.header.stamp = ros::Time::now();
@@ -236,6 +639,17 @@ namespace osm_planner {
         OSM_NODE point;
         point.longitude = lon;
         point.latitude = lat;
+
+        GraphLock graph_lock(this);
+        return getNearestPoint(getGraph().get(), point);
+    }
+
+    int Parser::getNearestPoint(GRAPH *graph, OSM_NODE point) {
+
+        if (!graph->grid.empty())
+            return getNearestPointInGrid(graph, point);
+
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
         int id = 0;
 
         double distance = Haversine::getDistance(point, nodes[0]);
@@ -254,41 +668,143 @@ namespace osm_planner {
     }
 
 
-    int Parser::getNearestPointXY(double point_x, double point_y) {
+    std::vector<int> Parser::getNearestPoints(const std::vector<OSM_NODE> &points) {
 
-        int id = 0;
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
 
-        double x = haversine.getCoordinateX(nodes[0]);
-        double y = haversine.getCoordinateY(nodes[0]);
-        double minDistance = sqrt(pow(point_x - x, 2.0) + pow(point_y - y, 2.0));
+        std::vector<int> ids(points.size());
+        for (int i = 0; i < points.size(); i++) {
+            ids[i] = getNearestPoint(graph.get(), points[i]);
+        }
+        return ids;
+    }
+
+    int Parser::getNearestPointXY(double point_x, double point_y) {
+
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+        const IntegerGraph &integer_graph = graph->integer_graph;
+        int id = -1;
+        double minDistance = 0;
 
         for (int i = 0; i < nodes.size(); i++) {
-            x = haversine.getCoordinateX(nodes[i]);
-            y = haversine.getCoordinateY(nodes[i]);
+
+            //node removed by update of map
+            if (i < integer_graph.size() && integer_graph.begin(i) == integer_graph.end(i))
+                continue;
+
+            double x = haversine.getCoordinateX(nodes[i]);
+            double y = haversine.getCoordinateY(nodes[i]);
 
 
             double distance = sqrt(pow(point_x - x, 2.0) + pow(point_y - y, 2.0));
 
-            if (minDistance > distance) {
+            if (id == -1 || minDistance > distance) {
                 minDistance = distance;
                 id = i;
             }
         }
+        return std::max(id, 0);
+    }
+
+    int Parser::trackNearestPoint(int previous_id, double lat, double lon, double max_distance) {
+
+        OSM_NODE point;
+        point.longitude = lon;
+        point.latitude = lat;
+
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
+
+        int id = walkToNearestPoint(graph.get(), previous_id, point, max_distance);
+        if (id == -1 || graph->grid.empty())
+            return getNearestPoint(graph.get(), point);
+
+        //walk ends in local minimum of its own way, nearer node of parallel or unconnected way
+        //or behind the curve of way is in the cells around the point
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+        double distance = Haversine::getDistance(point, nodes[id]);
+        std::vector<int> ids;
+        getPointsInGrid(graph.get(), point, distance, &ids);
+
+        for (int i = 0; i < ids.size(); i++) {
+            double node_distance = Haversine::getDistance(point, nodes[ids[i]]);
+            if (node_distance < distance) {
+                distance = node_distance;
+                id = ids[i];
+            }
+        }
         return id;
     }
 
+    int Parser::trackNearestPointXY(int previous_id, double point_x, double point_y, double max_distance) {
+
+        OSM_NODE point = haversine.getGeoPoint(point_x, point_y);
+        return trackNearestPoint(previous_id, point.latitude, point.longitude, max_distance);
+    }
+
+    std::vector<int> Parser::getPointsInRadius(double lat, double lon, double radius) {
+
+        OSM_NODE point;
+        point.longitude = lon;
+        point.latitude = lat;
+
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
+        const IntegerGraph &integer_graph = graph->integer_graph;
+
+        std::vector<int> ids;
+        if (!graph->grid.empty()) {
+            getPointsInGrid(graph.get(), point, radius, &ids);
+            return ids;
+        }
+
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+        for (int i = 0; i < nodes.size(); i++) {
+
+            //node removed by update of map
+            if (i < integer_graph.size() && integer_graph.begin(i) == integer_graph.end(i))
+                continue;
+
+            if (Haversine::getDistance(point, nodes[i]) <= radius)
+                ids.push_back(i);
+        }
+        return ids;
+    }
+
     //get distance and bearing calculator
     Parser::Haversine *Parser::getCalculator(){
 
         return &haversine;
     }
 
+    double Parser::getPathLength(const std::vector<int> &nodesInPath) {
+
+        GraphLock graph_lock(this);
+        boost::shared_ptr<GRAPH> graph = getGraph();
+
+        double length = 0;
+        for (int i = 1; i < nodesInPath.size(); i++) {
+            length += Haversine::getDistance(graph->nodes[nodesInPath[i - 1]], graph->nodes[nodesInPath[i]]);
+        }
+        return length;
+    }
+
 //return OSM NODE, which contains geographics coordinates
    Parser::OSM_NODE Parser::getNodeByID(int id) {
 
-        return nodes[id];
+        GraphLock graph_lock(this);
+        return getGraph()->nodes[id];
     }
 
+   boost::shared_ptr<const DistanceField> Parser::getDistanceField() {
+
+        boost::mutex::scoped_lock field_lock(distance_field_mutex);
+        return distance_field;
+   }
+
     /* SETTERS */
 
    void Parser::setStartPoint(double latitude, double longitude, double bearing) {
@@ -300,12 +816,15 @@ namespace osm_planner {
     //set random start pose
    void Parser::setStartPoint(){
 
+       GraphLock graph_lock(this);
+       boost::shared_ptr<GRAPH> graph = getGraph();
        int id =  (int) (((double)rand() / RAND_MAX) * size_of_nodes);
-       haversine.setOrigin(nodes[id].latitude, nodes[id].longitude);
+       haversine.setOrigin(graph->nodes[id].latitude, graph->nodes[id].longitude);
    }
 
    void Parser::setNewMap(std::string xml) {
 
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
         this->xml = xml;
         //parse();
    }
@@ -315,10 +834,155 @@ namespace osm_planner {
         this->types_of_ways = types;
     }
 
+   void Parser::setCropBoundingBox(double min_latitude, double min_longitude, double max_latitude, double max_longitude) {
+
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
+        crop.type = CROP_BOX;
+        crop.min_latitude = min_latitude;
+        crop.min_longitude = min_longitude;
+        crop.max_latitude = max_latitude;
+        crop.max_longitude = max_longitude;
+   }
+
+   //circle is tested by distance, its bounding box rejects the most of nodes without haversine
+   void Parser::setCropRadius(double latitude, double longitude, double radius) {
+
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
+        crop.type = CROP_RADIUS;
+        crop.center.latitude = latitude;
+        crop.center.longitude = longitude;
+        crop.radius = radius;
+
+        OSM_NODE north = {latitude + 1, longitude, 0, 0};
+        OSM_NODE east = {latitude, longitude + 1, 0, 0};
+        double lat_size = radius / Haversine::getDistance(crop.center, north);
+        double lon_size = radius / std::max(Haversine::getDistance(crop.center, east), 1.0);
+
+        crop.min_latitude = latitude - lat_size;
+        crop.max_latitude = latitude + lat_size;
+        crop.min_longitude = longitude - lon_size;
+        crop.max_longitude = longitude + lon_size;
+   }
+
+   bool Parser::isInCropRegion(OSM_NODE node) {
+
+        if (crop.type == NO_CROP)
+            return true;
+
+        if (node.latitude < crop.min_latitude || node.latitude > crop.max_latitude ||
+            node.longitude < crop.min_longitude || node.longitude > crop.max_longitude)
+            return false;
+
+        return crop.type == CROP_BOX || Haversine::getDistance(crop.center, node) <= crop.radius;
+   }
+
    void Parser::setInterpolationMaxDistance(double param) {
         this->interpolation_max_distance = param;
    }
 
+   void Parser::setDistanceField(double resolution, double margin, long max_cells) {
+
+        boost::mutex::scoped_lock field_lock(distance_field_mutex);
+        distance_field_resolution = resolution;
+        distance_field_margin = margin;
+        distance_field_max_cells = max_cells;
+        distance_field.reset();
+   }
+
+   //the old field is served until the new one is swapped
+   void Parser::buildDistanceField() {
+
+        boost::mutex::scoped_lock build_lock(distance_field_build_mutex);
+
+        boost::mutex::scoped_lock field_lock(distance_field_mutex);
+        double resolution = distance_field_resolution, margin = distance_field_margin;
+        long max_cells = distance_field_max_cells;
+        field_lock.unlock();
+
+        if (resolution <= 0)
+            return;
+
+        ros::Time start_time = ros::Time::now();
+        GraphLock graph_lock(this);
+        boost::shared_ptr<DistanceField> field(new DistanceField());
+        field->build(getGraph().get(), &haversine, resolution, margin, max_cells);
+        graph_lock.unlock();
+
+        field_lock.lock();
+        distance_field = field;
+        field_lock.unlock();
+
+        ROS_INFO("OSM planner: Distance field %.2f m, %ld kB, time: %f", field->getResolution(), field->getMemory() / 1024,
+                 (ros::Time::now() - start_time).toSec());
+   }
+
+   //field isn't built before the first buildDistanceField(), the origin can be unset yet
+   void Parser::updateDistanceField() {
+
+        boost::mutex::scoped_lock field_lock(distance_field_mutex);
+        if (!distance_field)
+            return;
+
+        //running build takes the changes by the next pass
+        if (distance_field_building) {
+            distance_field_outdated = true;
+            return;
+        }
+
+        if (distance_field_thread)
+            distance_field_thread->join();
+
+        distance_field_building = true;
+        distance_field_thread = boost::shared_ptr<boost::thread>(new boost::thread(&Parser::buildDistanceFieldThread, this));
+   }
+
+   //runs in background thread, it is called from the changing thread, which can hold the exclusive lock of graph
+   void Parser::buildDistanceFieldThread() {
+
+        while (true) {
+            buildDistanceField();
+
+            boost::mutex::scoped_lock field_lock(distance_field_mutex);
+            if (!distance_field_outdated) {
+                distance_field_building = false;
+                return;
+            }
+            distance_field_outdated = false;
+        }
+   }
+
+   //mode is set before the first parsing
+   void Parser::setSharedGraph(std::string name, int mode) {
+
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
+        shared_graph_name = name;
+        shared_graph_mode = mode;
+   }
+
+   bool Parser::isSharedGraphAttached() {
+
+        return shared_graph_mode == SHARED_GRAPH_ATTACH;
+   }
+
+   bool Parser::updateSharedGraph() {
+
+        boost::mutex::scoped_lock parse_lock(parse_mutex);
+
+        if (shared_graph_mode != SHARED_GRAPH_ATTACH)
+            return false;
+
+        boost::shared_ptr<GRAPH> current;
+        {
+            boost::mutex::scoped_lock lock(graph_pointer_mutex);
+            current = graph;
+        }
+
+        //nothing is attached before the first parsing, new segment can be still written
+        if (!current->segment || !current->segment->isReplaced())
+            return false;
+        return attachSharedGraph();
+   }
+
 
 //private functions
 
@@ -356,13 +1020,13 @@ namespace osm_planner {
 // osm_key = "highway"
 // osm_value = "footway"
 // will selected only footways
-   void Parser::createWays(TiXmlHandle *hRootWay, TiXmlHandle *hRootNode, std::vector<std::string> osm_value, bool onlyFirstElement) {
+   //all ways with refs and interned highway values, nodes out of crop region are discarded already here,
+   //so ways are clipped before any filtering and interpolation
+   boost::shared_ptr<Parser::WAY_STORE> Parser::createStore(TiXmlHandle *hRootWay, TiXmlHandle *hRootNode) {
 
-        //ADDED for interpolation
-        //------------------------------------------
-        //getting all OSM nodes for calculating distance between two nodes on the route
-        std::vector<OSM_NODE_WITH_ID> nodes;
-        OSM_NODE_WITH_ID nodeTmp;
+        boost::shared_ptr<WAY_STORE> store(new WAY_STORE());
+
+        OSM_NODE_WITH_ID nodeTmp = {0, {0, 0, 0, 0}};
         TiXmlElement *nodeElement = hRootNode->Element();
 
         for (nodeElement; nodeElement; nodeElement = nodeElement->NextSiblingElement("node")) {
@@ -370,39 +1034,160 @@ namespace osm_planner {
             nodeElement->Attribute("id", &nodeTmp.id);
             nodeElement->Attribute("lat", &nodeTmp.node.latitude);
             nodeElement->Attribute("lon", &nodeTmp.node.longitude);
-            nodes.push_back(nodeTmp);
+            if (!isInCropRegion(nodeTmp.node))
+                continue;
+
+            store->node_index[nodeTmp.id] = store->nodes.size();
+            store->node_ids.push_back(nodeTmp.id);
+            store->nodes.push_back(nodeTmp.node);
+        }
+
+        //bits are packed after all values are interned
+        boost::unordered_map<std::string, int> value_ids;
+        std::vector<std::vector<int> > way_tags;
+
+        for (TiXmlElement *wayElement = hRootWay->Element(); wayElement; wayElement = wayElement->NextSiblingElement("way")) {
+
+            int id;
+            wayElement->Attribute("id", &id);
+
+            std::vector<int> tags;
+            for (TiXmlElement *tag = wayElement->FirstChildElement("tag"); tag; tag = tag->NextSiblingElement("tag")) {
+
+                tags.push_back(TAG_ANY);
+                if (std::string(tag->Attribute("k")) != "highway")
+                    continue;
+
+                std::string value(tag->Attribute("v"));
+                boost::unordered_map<std::string, int>::iterator id = value_ids.find(value);
+                if (id == value_ids.end()) {
+                    id = value_ids.insert(std::make_pair(value, (int) store->values.size())).first;
+                    store->values.push_back(value);
+                }
+                tags.push_back(TAG_HIGHWAY);
+                tags.push_back(TAG_VALUES + id->second);
+            }
+
+            std::vector<int> refs;
+            std::vector<bool> known;
+            for (TiXmlElement *nd = wayElement->FirstChildElement("nd"); nd; nd = nd->NextSiblingElement("nd")) {
+                int ref;
+                nd->Attribute("ref", &ref);
+                refs.push_back(ref);
+                known.push_back(store->node_index.count(ref) > 0);
+            }
+
+            //way leaving and entering the crop region is split into more pieces with the same ID
+            std::vector<std::vector<int> > pieces;
+            if (crop.type != NO_CROP)
+                pieces = clipRefs(refs, known);
+            else if (!refs.empty())
+                pieces.push_back(refs);
+
+            for (int i = 0; i < pieces.size(); i++) {
+                store->way_ids.push_back(id);
+                store->way_refs.append(pieces[i]);
+                way_tags.push_back(tags);
+            }
+        }
+
+        store->words = (TAG_VALUES + store->values.size() + 63) / 64;
+        store->tags.resize(store->words * store->way_ids.size(), 0);
+
+        for (int i = 0; i < way_tags.size(); i++) {
+            for (int j = 0; j < way_tags[i].size(); j++) {
+                store->tags[i * store->words + way_tags[i][j] / 64] |= 1ULL << (way_tags[i][j] % 64);
+            }
+        }
+        return store;
+   }
+
+   std::vector<unsigned long long> Parser::getTagMask(const WAY_STORE &store, std::vector<std::string> values) {
+
+        std::vector<unsigned long long> mask(store.words, 0);
+        std::vector<int> bits;
+
+        if (values.size() == 0)
+            bits.push_back(TAG_ANY); //selected all
+        else if (values[0] == "all")
+            bits.push_back(TAG_HIGHWAY); //selected all ways with key highway
+        else {
+            for (int i = 0; i < store.values.size(); i++) {
+                if (std::find(values.begin(), values.end(), store.values[i]) != values.end())
+                    bits.push_back(TAG_VALUES + i);
+            }
         }
-        //------------------------------------------
+
+        for (int i = 0; i < bits.size(); i++) {
+            mask[bits[i] / 64] |= 1ULL << (bits[i] % 64);
+        }
+        return mask;
+   }
+
+   boost::shared_ptr<Parser::GRAPH> Parser::createGraph(boost::shared_ptr<const WAY_STORE> store, std::vector<std::string> types, bool onlyFirstElement) {
+
+        createWays(*store, getTagMask(*store, types), onlyFirstElement);
+        createNodes(*store, onlyFirstElement);
+
+        boost::shared_ptr<GRAPH> new_graph(new GRAPH());
+        new_graph->store = store;
+        new_graph->ways.swap(ways);
+        new_graph->nodes.swap(nodes);
+
+        if (!onlyFirstElement) {
+            createGrid(new_graph.get());
+            createIndex(new_graph.get());
+            createNetwork(new_graph.get());
+        }
+        new_graph->structure_version = new_graph->version = ++graph_version;
+        return new_graph;
+   }
+
+   //selected ways are converted to graph nodes, the store isn't changed
+   void Parser::createWays(const WAY_STORE &store, const std::vector<unsigned long long> &mask, bool onlyFirstElement) {
 
         ways.clear();
         table.clear();
+        translate_index.clear();
+        interpolated_nodes.clear();
         size_of_nodes = 0;
 
-        TiXmlElement *wayElement = hRootWay->Element();
-
         OSM_WAY wayTmp;
-        TiXmlElement *tag;
+        std::vector<int> refs;
 
-        //prejde vsetky elementy way
-        for (wayElement; wayElement; wayElement = wayElement->NextSiblingElement("way")) {
+        for (int i = 0; i < store.way_ids.size(); i++) {
 
-            tag = wayElement->FirstChildElement("tag");
-            wayElement->Attribute("id", &wayTmp.id);
+            bool selected = false;
+            for (int j = 0; j < store.words && !selected; j++) {
+                selected = (store.tags[i * store.words + j] & mask[j]) != 0;
+            }
+            if (!selected)
+                continue;
 
-            //prejde vsetky elementy tag
-            while (tag != NULL) {
+            wayTmp.id = store.way_ids[i];
+            store.way_refs.get(i, &refs);
+            getNodesInWay(refs, &wayTmp, store); //finding all nodes located in selected way
+            ways.push_back(wayTmp);
+            if (onlyFirstElement) return;
+        }
+   }
 
-                if (isSelectedWay(tag, osm_value)) {
+   std::vector<std::vector<int> > Parser::clipRefs(const std::vector<int> &refs, const std::vector<bool> &known) {
 
-                    wayElement->Attribute("id", &wayTmp.id);
-                    getNodesInWay(wayElement, &wayTmp, nodes); //finding all nodes located in selected way
-                    ways.push_back(wayTmp);
-                    if (onlyFirstElement) return;
-                    break;
-                }
-                tag = tag->NextSiblingElement("tag");
-            }
+        std::vector<std::vector<int> > pieces(1);
+        for (int i = 0; i < refs.size(); i++) {
+
+            if (known[i])
+                pieces.back().push_back(refs[i]);
+            else if (pieces.back().size() > 1)
+                pieces.push_back(std::vector<int>());
+            else
+                pieces.back().clear();
         }
+
+        if (pieces.back().size() < 2)
+            pieces.pop_back();
+        return pieces;
    }
 
    bool Parser::isSelectedWay(TiXmlElement *tag, std::vector<std::string> values) {
@@ -426,18 +1211,12 @@ namespace osm_planner {
    }
 
 //finding nodes located on way and fill way.nodesId
-   void Parser::getNodesInWay(TiXmlElement *wayElement, OSM_WAY *way, std::vector<OSM_NODE_WITH_ID> nodes) {
+   void Parser::getNodesInWay(const std::vector<int> &refs, OSM_WAY *way, const WAY_STORE &store) {
 
-        TiXmlHandle hRootNode(0);
-        TiXmlElement *nodeElement;
         int id;
 
         way->nodesId.clear();
-
-        nodeElement = wayElement->FirstChild("nd")->ToElement();
-        hRootNode = TiXmlHandle(nodeElement);
-
-        nodeElement = hRootNode.Element();
+        way->refs.clear();
 
         TRANSLATE_TABLE tableTmp;
 
@@ -449,22 +1228,23 @@ namespace osm_planner {
         int counter = 0;
         //------------------------------------------
 
-        for (nodeElement; nodeElement; nodeElement = nodeElement->NextSiblingElement("nd")) {
+        for (int i = 0; i < refs.size(); i++) {
 
-            nodeElement->Attribute("ref", &id);
+            id = refs[i];
+            way->refs.push_back(id);
 
             //ADDED for interpolation
             //------------------------------------------
             if (counter > 0) {
                 memcpy(&node_old, &node_new, sizeof(node_old));     //save information about node
-                node_new = getNodeByOsmId(nodes, id);               //get information about new node
+                node_new = getNodeByOsmId(store, id);               //get information about new node
 
                 new_nodes_list = getInterpolatedNodes(node_old.node, node_new.node); //do interpolation
                 tableTmp.oldID = -1; //interpolated node hasn't any ID in xml
 
-                for (int i = 0; i < new_nodes_list.size(); i++) { //get the interpolated nodes
+                for (int j = 0; j < new_nodes_list.size(); j++) { //get the interpolated nodes
 
-                    memcpy(&node_old.node, &new_nodes_list[i], sizeof(OSM_NODE)); //copy information about lon and lat
+                    memcpy(&node_old.node, &new_nodes_list[j], sizeof(OSM_NODE)); //copy information about lon and lat
                     node_old.id = size_of_nodes;           //set the ID
                     tableTmp.newID = size_of_nodes++;      //set the ID in translate table and increment ID
                     table.push_back(tableTmp);
@@ -473,7 +1253,7 @@ namespace osm_planner {
                 }
 
             } else {
-                node_new = getNodeByOsmId(nodes, id);       //get information about first node in way
+                node_new = getNodeByOsmId(store, id);       //get information about first node in way
             }
             //------------------------------------------
 
@@ -483,6 +1263,7 @@ namespace osm_planner {
 
                 tableTmp.newID = size_of_nodes++;
                 table.push_back(tableTmp);
+                translate_index[tableTmp.oldID] = tableTmp.newID;
                 way->nodesId.push_back(tableTmp.newID);
 
             } else {
@@ -500,14 +1281,16 @@ namespace osm_planner {
 //ADDED for interpolation
 //------------------------------------------
 //Finding nodes by OSM ID
-   Parser::OSM_NODE_WITH_ID Parser::getNodeByOsmId(std::vector<OSM_NODE_WITH_ID> nodes, int id) {
+   Parser::OSM_NODE_WITH_ID Parser::getNodeByOsmId(const WAY_STORE &store, int id) {
 
-        for (int i = 0; i < nodes.size(); i++) {
-            if (nodes[i].id == id)
-                return nodes[i];
+        boost::unordered_map<int, int>::const_iterator index = store.node_index.find(id);
+        if (index != store.node_index.end()) {
+            OSM_NODE_WITH_ID node = {id, store.nodes[index->second]};
+            return node;
         }
         ROS_ERROR("OSM planner: nenaslo ziadnu nodu - toto by sa nemalo stat");
-        return nodes[0];
+        OSM_NODE_WITH_ID node = {store.node_ids[0], store.nodes[0]};
+        return node;
    }
 
 //INTERPOLATION - main algorithm
@@ -536,25 +1319,19 @@ namespace osm_planner {
 //------------------------------------------
 
 
-   //parse all osm nodes and select nodes located in ways (footways)
-   void Parser::createNodes(TiXmlHandle *hRootNode, bool onlyFirstElement) {
+   //select nodes located in ways (footways)
+   void Parser::createNodes(const WAY_STORE &store, bool onlyFirstElement) {
 
         nodes.clear();
         nodes.resize(table.size());
 
-        TiXmlElement *nodeElement = hRootNode->Element();
-
-        int id;
-        for (nodeElement; nodeElement; nodeElement = nodeElement->NextSiblingElement("node")) {
+        //coordinates of osm nodes are taken from the store by translate table
+        for (int i = 0; i < table.size(); i++) {
 
-            nodeElement->Attribute("id", &id);
-            int ret;
-            if (!translateID(id, &ret)) {
+            if (table[i].oldID == -1)
                 continue;
-            }
 
-            nodeElement->Attribute("lat", &nodes[ret].latitude);
-            nodeElement->Attribute("lon", &nodes[ret].longitude);
+            nodes.set(table[i].newID, getNodeByOsmId(store, table[i].oldID).node);
             if (onlyFirstElement) return;
         }
 
@@ -565,14 +1342,256 @@ namespace osm_planner {
         //interpolated_nodes[i].id - index of nodes from traslate table
         for (int i = 0; i < interpolated_nodes.size(); i++) {
 
-            memcpy(&nodes[interpolated_nodes[i].id], &interpolated_nodes[i].node, sizeof(OSM_NODE));
+            nodes.set(interpolated_nodes[i].id, interpolated_nodes[i].node);
         }
         //------------------------------------------
 
    }
 
+   //free slots of adjacency lists aren't copied, matrix and ways aren't shared
+   void Parser::publishSharedGraph(GRAPH *graph) {
+
+        const IntegerGraph &integer_graph = graph->integer_graph;
+        int size = integer_graph.size();
+
+        int slots = 0;
+        for (int u = 0; u < size; u++) {
+            slots += integer_graph.end(u) - integer_graph.begin(u);
+        }
+
+        boost::shared_ptr<GraphSegment> segment = GraphSegment::create(shared_graph_name, graph->version, size, slots,
+                                                                       integer_graph.getMaxWeight());
+        if (!segment)
+            return;
+
+        std::copy(graph->nodes.getLatitudes(), graph->nodes.getLatitudes() + size, segment->getLatitudes());
+        std::copy(graph->nodes.getLongitudes(), graph->nodes.getLongitudes() + size, segment->getLongitudes());
+
+        int *offsets = segment->getOffsets();
+        int *targets = segment->getTargets();
+        unsigned int *weights = segment->getWeights();
+        int slot = 0;
+
+        for (int u = 0; u < size; u++) {
+            offsets[u] = slot;
+            for (int e = integer_graph.begin(u); e < integer_graph.end(u); e++) {
+                targets[slot] = integer_graph.target(e);
+                weights[slot] = integer_graph.weight(e);
+                slot++;
+            }
+        }
+        offsets[size] = slot;
+        segment->setReady();
+
+        ROS_INFO("OSM planner: Graph was published to shared memory %s, %d nodes, %lu bytes", shared_graph_name.c_str(),
+                 size, (unsigned long) segment->getSize());
+   }
+
+   bool Parser::attachSharedGraph() {
+
+        boost::shared_ptr<GraphSegment> segment = GraphSegment::attach(shared_graph_name);
+        if (!segment)
+            return false;
+
+        boost::shared_ptr<GRAPH> new_graph(new GRAPH());
+        int size = segment->getNodes();
+
+        new_graph->segment = segment;
+        new_graph->nodes.attach(size, segment->getLatitudes(), segment->getLongitudes());
+        new_graph->integer_graph.attach(size, segment->getSlots(), segment->getOffsets(), segment->getOffsets() + 1,
+                                        segment->getTargets(), segment->getWeights(), segment->getMaxWeight());
+
+        //removed nodes of the publisher have no edges, they aren't snapped
+        for (int u = 0; u < size; u++) {
+            if (new_graph->integer_graph.begin(u) == new_graph->integer_graph.end(u))
+                new_graph->free_nodes.push_back(u);
+        }
+
+        //grid is own, it is small against the shared arrays
+        createGrid(new_graph.get());
+        for (int i = 0; i < new_graph->free_nodes.size(); i++) {
+            setGridCell(new_graph.get(), new_graph->free_nodes[i], false);
+        }
+
+        new_graph->structure_version = new_graph->version = ++graph_version;
+        size_of_nodes = size;
+
+        {
+            boost::mutex::scoped_lock lock(graph_pointer_mutex);
+            graph.swap(new_graph);
+        }
+        updateDistanceField();
+
+        ROS_INFO("OSM planner: Attached shared graph %s, %d nodes, version %lu of publisher", shared_graph_name.c_str(),
+                 size, segment->getVersion());
+        return true;
+   }
+
+   //spatial index - every node is in the cell of its coordinates
+   void Parser::createGrid(GRAPH *graph) {
+
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+        std::vector<std::vector<int> > &grid = graph->grid;
+
+        grid.clear();
+        if (nodes.empty())
+            return;
+
+        double max_latitude = nodes[0].latitude, max_longitude = nodes[0].longitude;
+        graph->grid_min_latitude = nodes[0].latitude;
+        graph->grid_min_longitude = nodes[0].longitude;
+
+        for (int i = 1; i < nodes.size(); i++) {
+            graph->grid_min_latitude = std::min(graph->grid_min_latitude, nodes[i].latitude);
+            graph->grid_min_longitude = std::min(graph->grid_min_longitude, nodes[i].longitude);
+            max_latitude = std::max(max_latitude, nodes[i].latitude);
+            max_longitude = std::max(max_longitude, nodes[i].longitude);
+        }
+
+        //few nodes per cell also on big sparse maps
+        graph->grid_cell_size = GRID_CELL_SIZE;
+        while (((max_latitude - graph->grid_min_latitude) / graph->grid_cell_size + 1) * ((max_longitude - graph->grid_min_longitude) / graph->grid_cell_size + 1) > 4 * nodes.size() + 16)
+            graph->grid_cell_size *= 2;
+
+        graph->grid_rows = (int) ((max_latitude - graph->grid_min_latitude) / graph->grid_cell_size) + 1;
+        graph->grid_cols = (int) ((max_longitude - graph->grid_min_longitude) / graph->grid_cell_size) + 1;
+        grid.resize(graph->grid_rows * graph->grid_cols);
+
+        for (int i = 0; i < nodes.size(); i++) {
+            int row = (int) ((nodes[i].latitude - graph->grid_min_latitude) / graph->grid_cell_size);
+            int col = (int) ((nodes[i].longitude - graph->grid_min_longitude) / graph->grid_cell_size);
+            grid[row * graph->grid_cols + col].push_back(i);
+        }
+
+        //cells are narrowest on the latitude most distant from equator
+        OSM_NODE corner1, corner2;
+        corner1.latitude = corner2.latitude = std::max(fabs(graph->grid_min_latitude), fabs(max_latitude));
+        corner1.longitude = 0;
+        corner2.longitude = graph->grid_cell_size;
+        double width = Haversine::getDistance(corner1, corner2);
+
+        corner2.latitude = corner1.latitude - graph->grid_cell_size;
+        corner2.longitude = 0;
+        double height = Haversine::getDistance(corner1, corner2);
+
+        graph->grid_cell_metres = 0.99 * std::min(width, height);
+   }
+
+   //cells are searched in rings around the cell of point, until no closer node can be in next ring
+   int Parser::getNearestPointInGrid(GRAPH *graph, OSM_NODE point) {
+
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+
+        //point out of the grid starts from the nearest border cell, cells in ring around it are still
+        //at least (ring - 1) cells far from the point, so the rings are bounded by the size of grid
+        double grid_row = floor((point.latitude - graph->grid_min_latitude) / graph->grid_cell_size);
+        double grid_col = floor((point.longitude - graph->grid_min_longitude) / graph->grid_cell_size);
+        int row = (int) std::max(0.0, std::min(grid_row, graph->grid_rows - 1.0));
+        int col = (int) std::max(0.0, std::min(grid_col, graph->grid_cols - 1.0));
+        int max_ring = std::max(std::max(row, graph->grid_rows - 1 - row), std::max(col, graph->grid_cols - 1 - col));
+
+        int id = -1;
+        double minDistance = 0;
+
+        for (int ring = 0; ring <= max_ring; ring++) {
+
+            //nodes in this ring are at least (ring - 1) cells far away
+            if (id != -1 && minDistance <= (ring - 1) * graph->grid_cell_metres)
+                break;
+
+            for (int r = row - ring; r <= row + ring; r++) {
+
+                if (r < 0 || r >= graph->grid_rows)
+                    continue;
+
+                int step = (r == row - ring || r == row + ring) ? 1 : 2 * ring;
+                for (int c = col - ring; c <= col + ring; c += std::max(step, 1)) {
+
+                    if (c < 0 || c >= graph->grid_cols)
+                        continue;
+
+                    const std::vector<int> &cell = graph->grid[r * graph->grid_cols + c];
+                    for (int i = 0; i < cell.size(); i++) {
+                        double distance = Haversine::getDistance(point, nodes[cell[i]]);
+                        if (id == -1 || distance < minDistance) {
+                            minDistance = distance;
+                            id = cell[i];
+                        }
+                    }
+                }
+            }
+        }
+        return id;
+   }
+
+   //cells of rings around the cell of point, which can contain nodes within radius
+   void Parser::getPointsInGrid(GRAPH *graph, OSM_NODE point, double radius, std::vector<int> *ids) {
+
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+
+        //cell is at least grid_cell_metres wide and high, so the circle is within radius / grid_cell_metres cells,
+        //cells are clamped in doubles, point far out of the grid doesn't overflow
+        double row = (point.latitude - graph->grid_min_latitude) / graph->grid_cell_size;
+        double col = (point.longitude - graph->grid_min_longitude) / graph->grid_cell_size;
+        double cells = radius / graph->grid_cell_metres;
+
+        int min_row = (int) std::max(floor(row - cells), 0.0), max_row = (int) std::min(floor(row + cells), graph->grid_rows - 1.0);
+        int min_col = (int) std::max(floor(col - cells), 0.0), max_col = (int) std::min(floor(col + cells), graph->grid_cols - 1.0);
+
+        for (int r = min_row; r <= max_row; r++) {
+            for (int c = min_col; c <= max_col; c++) {
+
+                const std::vector<int> &cell = graph->grid[r * graph->grid_cols + c];
+                for (int i = 0; i < cell.size(); i++) {
+                    if (Haversine::getDistance(point, nodes[cell[i]]) <= radius)
+                        ids->push_back(cell[i]);
+                }
+            }
+        }
+   }
+
+   //moves to the neighbour closest to the point while it is closer than the current node, the robot moves
+   //centimetres between updates, so it ends after few steps, its result bounds the radius of the grid check
+   int Parser::walkToNearestPoint(GRAPH *graph, int id, OSM_NODE point, double max_distance) {
+
+        const IntegerGraph &integer_graph = graph->integer_graph;
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+
+        //removed node or node of old graph
+        if (max_distance <= 0 || id < 0 || id >= integer_graph.size() || id >= nodes.size()
+            || integer_graph.begin(id) == integer_graph.end(id))
+            return -1;
+
+        //robot jumped, the nearest node can be on other way
+        double distance = Haversine::getDistance(point, nodes[id]);
+        if (distance > max_distance)
+            return -1;
+
+        for (int step = 0; step < MAX_TRACKING_STEPS; step++) {
+
+            int next = -1;
+            for (int e = integer_graph.begin(id); e < integer_graph.end(id); e++) {
+                int neighbour = integer_graph.target(e);
+                double neighbour_distance = Haversine::getDistance(point, nodes[neighbour]);
+                if (neighbour_distance < distance) {
+                    distance = neighbour_distance;
+                    next = neighbour;
+                }
+            }
+
+            if (next == -1)
+                return id;
+            id = next;
+        }
+        return -1;
+   }
+
    //creating graph for dijkstra algorithm
-   void Parser::createNetwork() {
+   void Parser::createNetwork(GRAPH *graph) {
+
+        const NodeStore<OSM_NODE> &nodes = graph->nodes;
+        const std::vector<OSM_WAY> &ways = graph->ways;
+        std::vector<std::vector<float> > &networkArray = graph->networkArray;
 
         networkArray.clear();
         networkArray.resize(nodes.size(), std::vector<float>(nodes.size(), 0.0));
@@ -601,6 +1620,10 @@ namespace osm_planner {
         }
         interpolated_nodes.clear();
         table.clear();
+        translate_index.clear();
+
+        //integer variant of the same graph for bucket and radix heap searches
+        graph->integer_graph.build(&networkArray, INTEGER_GRAPH_SCALE, EDGE_SLACK);
 
        /* networkArray.clear();
         for (int i = 0; i < networkArray.size(); i++) {
@@ -610,18 +1633,283 @@ namespace osm_planner {
    }
 
 
-//preklada stare osm node ID na nove osm node ID (cielom bolo vytvorit usporiadane indexovanie)
-   bool Parser::translateID(int id, int *ret_value) {
+   //index of osm IDs from buffers of parsing, translate table must be still filled
+   void Parser::createIndex(GRAPH *graph) {
 
+        graph->osm_nodes.clear();
+        graph->removed_osm_nodes.clear();
+        graph->node_index.clear();
+        graph->node_ways.clear();
+        graph->way_index.clear();
+        graph->free_nodes.clear();
+
+        //interpolated nodes haven't osm ID
         for (int i = 0; i < table.size(); i++) {
-            if (table[i].oldID == id) {
-                ret_value[0] = table[i].newID;
-                return true;
+            if (table[i].oldID != -1)
+                graph->node_index[table[i].oldID] = table[i].newID;
+        }
+
+        for (int i = 0; i < graph->ways.size(); i++) {
+            graph->way_index.insert(std::make_pair(graph->ways[i].id, i));
+            for (int j = 0; j < graph->ways[i].refs.size(); j++) {
+                graph->node_ways[graph->ways[i].refs[j]].push_back(graph->ways[i].id);
             }
         }
+   }
+
+   bool Parser::isSelectedWay(TiXmlElement *wayElement) {
+
+        for (TiXmlElement *tag = wayElement->FirstChildElement("tag"); tag; tag = tag->NextSiblingElement("tag")) {
+            if (isSelectedWay(tag, types_of_ways))
+                return true;
+        }
         return false;
    }
 
+   //nodes of way are created from refs like in getNodesInWay(), existing nodes are shared
+   void Parser::addWay(GRAPH *graph, OSM_WAY way) {
+
+        std::vector<OSM_NODE> coordinates(way.refs.size());
+        std::vector<bool> known(way.refs.size());
+        for (int i = 0; i < way.refs.size(); i++) {
+            known[i] = findOsmNode(graph, way.refs[i], &coordinates[i]);
+        }
+
+        for (int i = 0; i < way.refs.size(); i++) {
+            if (known[i])
+                continue;
+
+            //nodes out of crop region aren't known, way is clipped like in createStore()
+            if (crop.type != NO_CROP) {
+                std::vector<std::vector<int> > pieces = clipRefs(way.refs, known);
+                for (int j = 0; j < pieces.size(); j++) {
+                    way.refs = pieces[j];
+                    addWay(graph, way);
+                }
+                return;
+            }
+
+            ROS_WARN("OSM planner: Way %d uses unknown node %d, it is skipped", way.id, way.refs[i]);
+            return;
+        }
+
+        way.nodesId.clear();
+        for (int i = 0; i < way.refs.size(); i++) {
+
+            const OSM_NODE &node = coordinates[i];
+
+            if (i > 0) {
+                std::vector<OSM_NODE> new_nodes_list = getInterpolatedNodes(coordinates[i - 1], node);
+                for (int j = 0; j < new_nodes_list.size(); j++) {
+                    way.nodesId.push_back(addNode(graph, new_nodes_list[j]));
+                }
+            }
+
+            boost::unordered_map<int, int>::iterator index = graph->node_index.find(way.refs[i]);
+            if (index == graph->node_index.end())
+                index = graph->node_index.insert(std::make_pair(way.refs[i], addNode(graph, node))).first;
+
+            way.nodesId.push_back(index->second);
+            graph->node_ways[way.refs[i]].push_back(way.id);
+        }
+
+        for (int i = 1; i < way.nodesId.size(); i++) {
+            setEdge(graph, way.nodesId[i - 1], way.nodesId[i],
+                    Haversine::getDistance(graph->nodes[way.nodesId[i - 1]], graph->nodes[way.nodesId[i]]));
+        }
+
+        graph->way_index.insert(std::make_pair(way.id, (int) graph->ways.size()));
+        graph->ways.push_back(way);
+   }
+
+   void Parser::removeWay(GRAPH *graph, int wayID) {
+
+        boost::unordered_multimap<int, int>::iterator index;
+        while ((index = graph->way_index.find(wayID)) != graph->way_index.end()) {
+            removeWayPiece(graph, index);
+        }
+   }
+
+   //nodes, which aren't used by other ways, are removed too
+   void Parser::removeWayPiece(GRAPH *graph, boost::unordered_multimap<int, int>::iterator index) {
+
+        int wayID = index->first;
+        int position = index->second;
+        OSM_WAY way = graph->ways[position];
+
+        for (int i = 1; i < way.nodesId.size(); i++) {
+            removeEdge(graph, way.nodesId[i - 1], way.nodesId[i]);
+        }
+
+        //osm nodes are in nodesId in the order of refs, other nodes are interpolated
+        int ref = 0;
+        for (int i = 0; i < way.nodesId.size(); i++) {
+
+            boost::unordered_map<int, int>::iterator node = ref < way.refs.size() ? graph->node_index.find(way.refs[ref]) : graph->node_index.end();
+            if (node == graph->node_index.end() || node->second != way.nodesId[i]) {
+                removeNode(graph, way.nodesId[i]);
+                continue;
+            }
+
+            std::vector<int> &ways = graph->node_ways[way.refs[ref]];
+            ways.erase(std::find(ways.begin(), ways.end(), wayID));
+            if (ways.empty()) {
+                graph->node_ways.erase(way.refs[ref]);
+                graph->node_index.erase(node);
+                removeNode(graph, way.nodesId[i]);
+            }
+            ref++;
+        }
+
+        //the last way takes the place of removed one
+        graph->way_index.erase(index);
+        int last = graph->ways.size() - 1;
+        if (position != last) {
+            graph->ways[position] = graph->ways.back();
+
+            std::pair<boost::unordered_multimap<int, int>::iterator, boost::unordered_multimap<int, int>::iterator> range = graph->way_index.equal_range(graph->ways[position].id);
+            for (boost::unordered_multimap<int, int>::iterator it = range.first; it != range.second; it++) {
+                if (it->second == last)
+                    it->second = position;
+            }
+        }
+        graph->ways.pop_back();
+   }
+
+   //free slot is reused, else the matrix and the adjacency lists get new node
+   int Parser::addNode(GRAPH *graph, OSM_NODE node) {
+
+        int id;
+        if (!graph->free_nodes.empty()) {
+            id = graph->free_nodes.back();
+            graph->free_nodes.pop_back();
+            graph->nodes.set(id, node);
+
+        } else {
+            id = graph->nodes.size();
+            graph->nodes.push_back(node);
+
+            std::vector<std::vector<float> > &networkArray = graph->networkArray;
+            for (int i = 0; i < networkArray.size(); i++) {
+                networkArray[i].push_back(0);
+            }
+            networkArray.push_back(std::vector<float>(id + 1, 0));
+            graph->integer_graph.addNode();
+        }
+
+        setGridCell(graph, id, true);
+        return id;
+   }
+
+   void Parser::removeNode(GRAPH *graph, int nodeID) {
+
+        IntegerGraph &integer_graph = graph->integer_graph;
+        while (integer_graph.begin(nodeID) < integer_graph.end(nodeID)) {
+            removeEdge(graph, nodeID, integer_graph.target(integer_graph.begin(nodeID)));
+        }
+
+        setGridCell(graph, nodeID, false);
+        graph->free_nodes.push_back(nodeID);
+   }
+
+   void Parser::setEdge(GRAPH *graph, int nodeID_1, int nodeID_2, double distance) {
+
+        graph->networkArray[nodeID_1][nodeID_2] = (float) distance;
+        graph->networkArray[nodeID_2][nodeID_1] = (float) distance;
+        graph->integer_graph.setEdge(nodeID_1, nodeID_2, distance * INTEGER_GRAPH_SCALE);
+        graph->integer_graph.setEdge(nodeID_2, nodeID_1, distance * INTEGER_GRAPH_SCALE);
+   }
+
+   void Parser::removeEdge(GRAPH *graph, int nodeID_1, int nodeID_2) {
+
+        graph->networkArray[nodeID_1][nodeID_2] = 0;
+        graph->networkArray[nodeID_2][nodeID_1] = 0;
+        graph->integer_graph.removeEdge(nodeID_1, nodeID_2);
+        graph->integer_graph.removeEdge(nodeID_2, nodeID_1);
+   }
+
+   void Parser::setGridCell(GRAPH *graph, int nodeID, bool add) {
+
+        OSM_NODE node = graph->nodes[nodeID];
+        int row = (int) floor((node.latitude - graph->grid_min_latitude) / graph->grid_cell_size);
+        int col = (int) floor((node.longitude - graph->grid_min_longitude) / graph->grid_cell_size);
+        bool inside = !graph->grid.empty() && row >= 0 && row < graph->grid_rows && col >= 0 && col < graph->grid_cols;
+
+        if (!add) {
+            if (inside) {
+                std::vector<int> &cell = graph->grid[row * graph->grid_cols + col];
+                std::vector<int>::iterator it = std::find(cell.begin(), cell.end(), nodeID);
+                if (it != cell.end())
+                    cell.erase(it);
+            }
+            return;
+        }
+
+        if (inside) {
+            graph->grid[row * graph->grid_cols + col].push_back(nodeID);
+            return;
+        }
+
+        grid_outdated = true;
+   }
+
+   //whole grid is rebuilt once after update, if some node was out of it, removed nodes are taken out of the new grid
+   void Parser::updateGrid(GRAPH *graph) {
+
+        if (!grid_outdated)
+            return;
+
+        createGrid(graph);
+        for (int i = 0; i < graph->free_nodes.size(); i++) {
+            setGridCell(graph, graph->free_nodes[i], false);
+        }
+        grid_outdated = false;
+   }
+
+   bool Parser::findOsmNode(GRAPH *graph, int id, OSM_NODE *node) {
+
+        boost::unordered_map<int, OSM_NODE>::iterator changed = graph->osm_nodes.find(id);
+        if (changed != graph->osm_nodes.end()) {
+            *node = changed->second;
+            return true;
+        }
+
+        if (!graph->store || graph->removed_osm_nodes.count(id))
+            return false;
+
+        boost::unordered_map<int, int>::const_iterator index = graph->store->node_index.find(id);
+        if (index == graph->store->node_index.end())
+            return false;
+
+        *node = graph->store->nodes[index->second];
+        return true;
+   }
+
+   void Parser::setOsmNode(GRAPH *graph, int id, OSM_NODE node) {
+
+        graph->osm_nodes[id] = node;
+        graph->removed_osm_nodes.erase(id);
+   }
+
+   //the store is shared with other graphs, so its nodes are only marked
+   void Parser::removeOsmNode(GRAPH *graph, int id) {
+
+        graph->osm_nodes.erase(id);
+        if (graph->store && graph->store->node_index.count(id))
+            graph->removed_osm_nodes.insert(id);
+   }
+
+//preklada stare osm node ID na nove osm node ID (cielom bolo vytvorit usporiadane indexovanie)
+   bool Parser::translateID(int id, int *ret_value) {
+
+        boost::unordered_map<int, int>::iterator index = translate_index.find(id);
+        if (index == translate_index.end())
+            return false;
+
+        ret_value[0] = index->second;
+        return true;
+   }
+
 }
 
 
@@ -18,19 +18,68 @@ namespace osm_planner {
 
 
     Planner::Planner() :
-            osm(), dijkstra(), localization(&osm), n("~/Planner") {
+            osm(), tiles(&osm), workspaces(), localization(&osm), n("~/Planner") {
 
-        initialized_ros = false;
+        initializeMembers();
+        initialize();
+    }
+
+    Planner::Planner(Executor *executor) :
+            osm(), tiles(&osm), workspaces(), localization(&osm), n("~/Planner") {
+
+        initializeMembers();
+
+        n.setCallbackQueue(executor->getPlanningQueue());
+        localization.setCallbackQueue(executor->getLocalizationQueue());
+        osm.setVisualizationQueue(executor->getVisualizationQueue());
+        initialize();
+    }
+
+    Planner::Planner(std::string name) :
+            osm("", "~/" + name), tiles(&osm), workspaces(), localization(&osm, "~/" + name), n("~/" + name) {
+
+        initializeMembers();
         initialize();
     }
 
     Planner::Planner(std::string name, costmap_2d::Costmap2DROS* costmap_ros) :
-            osm(), dijkstra(), localization(&osm), n("~"+name) {
+            osm(), tiles(&osm), workspaces(), localization(&osm), n("~"+name) {
 
-        initialized_ros = false;
+        initializeMembers();
         initialize(name, costmap_ros);
     }
 
+    Planner::~Planner() {
+
+        boost::mutex::scoped_lock lock(async_mutex);
+        cancelAsyncSearch(lock);
+        lock.unlock();
+
+        if (landmarks_thread)
+            landmarks_thread->join();
+
+        if (hub_labels_thread)
+            hub_labels_thread->join();
+
+        if (next_hop_table_thread)
+            next_hop_table_thread->join();
+
+        if (reload_thread)
+            reload_thread->join();
+    }
+
+
+    //members, which aren't set by params, the same for every constructor
+    void Planner::initializeMembers() {
+
+        initialized_ros = false;
+        async_running = false;
+        landmarks_building = false;
+        hub_labels_building = false;
+        next_hop_table_building = false;
+        alternatives_version = 0;
+        reloading = false;
+    }
 
     /*--------------------PUBLIC FUNCTIONS---------------------*/
 
@@ -51,6 +100,48 @@ namespace osm_planner {
             std::string file = "skuska.osm";
             n.getParam("osm_map_path", file);
             osm.setNewMap(file);
+            map_file = file;
+
+            //only the region of bounding box [min_lat, min_lon, max_lat, max_lon] or within crop_radius [m] around the origin is parsed
+            std::vector<double> crop_bounding_box;
+            double crop_radius;
+            n.getParam("crop_bounding_box", crop_bounding_box);
+            n.param<double>("crop_radius", crop_radius, 0);
+
+            if (crop_bounding_box.size() == 4) {
+                osm.setCropBoundingBox(crop_bounding_box[0], crop_bounding_box[1], crop_bounding_box[2], crop_bounding_box[3]);
+            } else if (crop_radius > 0) {
+                double crop_lat, crop_lon;
+                n.param<double>("origin_latitude", crop_lat, 0);
+                n.param<double>("origin_longitude", crop_lon, 0);
+                osm.setCropRadius(crop_lat, crop_lon, crop_radius);
+            } else if (!crop_bounding_box.empty()) {
+                ROS_WARN("OSM planner: crop_bounding_box must be [min_lat, min_lon, max_lat, max_lon], whole map is parsed");
+            }
+
+            //A* with landmarks, tables are saved next to the map
+            n.param<bool>("use_astar", use_astar, true);
+            n.param<int>("landmarks_count", landmarks_count, 8);
+            n.param<std::string>("landmarks_file", landmarks_file, file + ".landmarks");
+
+            //hub labels are used only for maps up to hub_labels_max_nodes nodes
+            n.param<bool>("use_hub_labels", use_hub_labels, false);
+            n.param<int>("hub_labels_max_nodes", hub_labels_max_nodes, 5000);
+
+            //all-pairs next hop table for tiny maps, 0 - disabled
+            n.param<int>("all_pairs_max_nodes", all_pairs_max_nodes, 0);
+
+            //alternative routes for fast replanning in cancelPoint()
+            n.param<int>("alternative_routes", alternative_routes, 0);
+            n.param<double>("alternative_max_stretch", alternative_max_stretch, 1.4);
+            n.param<double>("alternative_max_share", alternative_max_share, 0.7);
+
+            //matrix - A* or Dijkstra on adjacency matrix, radix_heap or bucket - Dijkstra on integer adjacency lists
+            n.param<std::string>("search_kernel", search_kernel, "matrix");
+            if (search_kernel != "matrix" && search_kernel != "radix_heap" && search_kernel != "bucket") {
+                ROS_WARN("OSM planner: Unknown search kernel %s, matrix is used", search_kernel.c_str());
+                search_kernel = "matrix";
+            }
 
             std::vector<std::string> types_of_ways;
             n.getParam("filter_of_ways",types_of_ways);
@@ -59,6 +150,25 @@ namespace osm_planner {
             std::string topic_name;
             n.param<std::string>("topic_shortest_path", topic_name, "/shortest_path");
 
+            //count of parallel searches, every one has own workspace
+            n.param<int>("planner_threads", planner_threads, boost::thread::hardware_concurrency());
+            if (planner_threads < 1)
+                planner_threads = 1;
+            workspaces.resize(planner_threads);
+
+            n.param<int>("reachability_threads", reachability_threads, boost::thread::hardware_concurrency());
+            n.param<double>("delta_stepping_bucket", delta_stepping_bucket, 10.0);
+
+            //cache of routes between snapped nodes, 0 - disabled
+            int route_cache_max_entries;
+            n.param<int>("route_cache_max_entries", route_cache_max_entries, 100);
+            n.param<bool>("route_cache_paths", route_cache_paths, true);
+            route_cache.setMaxEntries(route_cache_max_entries);
+
+            //makePlan() of nav_core plugin waits for the search max planning_deadline seconds
+            n.param<bool>("async_planning", async_planning, false);
+            n.param<double>("planning_deadline", planning_deadline, 0.5);
+
             //publishers
             shortest_path_pub = n.advertise<nav_msgs::Path>(topic_name, 10);
 
@@ -67,6 +177,63 @@ namespace osm_planner {
             //services
              cancel_point_service = n.advertiseService("cancel_point", &Planner::cancelPointCallback, this);
             drawing_route_service = n.advertiseService("draw_route", &Planner::drawingRouteCallback, this);
+            distance_matrix_service = n.advertiseService("distance_matrix", &Planner::distanceMatrixCallback, this);
+            route_cache_stats_service = n.advertiseService("route_cache_stats", &Planner::routeCacheStatsCallback, this);
+            reachability_service = n.advertiseService("reachability", &Planner::reachabilityCallback, this);
+            via_points_service = n.advertiseService("via_points", &Planner::viaPointsCallback, this);
+            reload_map_service = n.advertiseService("reload_map", &Planner::reloadMapCallback, this);
+            apply_map_change_service = n.advertiseService("apply_map_change", &Planner::applyMapChangeCallback, this);
+            set_filter_of_ways_service = n.advertiseService("set_filter_of_ways", &Planner::setFilterOfWaysCallback, this);
+
+            //graph in shared memory, publish - every new graph is written for other planners on this machine,
+            //attach - graph of other process is used instead of parsing, it has no matrix
+            std::string shared_graph, shared_graph_mode;
+            double shared_graph_check_period;
+            n.param<std::string>("shared_graph", shared_graph, "");
+            n.param<std::string>("shared_graph_mode", shared_graph_mode, "attach");
+            n.param<double>("shared_graph_check_period", shared_graph_check_period, 1.0);
+
+            if (shared_graph.empty()) {
+                //graph isn't shared
+            } else if (shared_graph_mode == "publish") {
+                osm.setSharedGraph(shared_graph, Parser::SHARED_GRAPH_PUBLISH);
+
+            } else if (shared_graph_mode == "attach") {
+                osm.setSharedGraph(shared_graph, Parser::SHARED_GRAPH_ATTACH);
+
+                if (search_kernel == "matrix") {
+                    ROS_WARN("OSM planner: Shared graph has no matrix, radix_heap search kernel is used");
+                    search_kernel = "radix_heap";
+                }
+                async_planning = false;
+                landmarks_count = 0;
+                use_hub_labels = false;
+                all_pairs_max_nodes = 0;
+
+                //new graph of the publisher is attached in the callback
+                shared_graph_timer = n.createTimer(ros::Duration(shared_graph_check_period), &Planner::sharedGraphCallback, this);
+            } else {
+                ROS_WARN("OSM planner: Unknown shared graph mode %s, graph isn't shared", shared_graph_mode.c_str());
+            }
+
+            //compiled map is loaded by tiles around the robot and along the routes
+            std::string tiles_directory;
+            int tiles_max_loaded, tiles_prefetch_radius;
+            n.param<std::string>("tiles_directory", tiles_directory, "");
+            n.param<int>("tiles_max_loaded", tiles_max_loaded, 25);
+            n.param<int>("tiles_prefetch_radius", tiles_prefetch_radius, 1);
+            n.param<int>("tiles_corridor_radius", tiles_corridor_radius, 1);
+            if (!tiles_directory.empty() && osm.isSharedGraphAttached()) {
+                ROS_WARN("OSM planner: Shared graph is attached, tiles of %s aren't loaded", tiles_directory.c_str());
+
+            } else if (!tiles_directory.empty() && tiles.open(tiles_directory, tiles_max_loaded, tiles_prefetch_radius)) {
+                localization.setTileCache(&tiles);
+
+                //lower bounds of landmarks aren't valid after the working set of tiles is changed,
+                //all-pairs table would be rebuilt after every loaded tile
+                landmarks_count = 0;
+                all_pairs_max_nodes = 0;
+            }
 
             initialized_ros = true;
 
@@ -111,8 +278,21 @@ namespace osm_planner {
         //Set the start pose to plan
         plan.push_back(start);
 
+        if (tiles.isOpen()) {
+            std::vector<Parser::OSM_NODE> corridor;
+            corridor.push_back(osm.getCalculator()->getGeoPoint(start.pose.position.x, start.pose.position.y));
+            corridor.push_back(osm.getCalculator()->getGeoPoint(goal.pose.position.x, goal.pose.position.y));
+            loadCorridor(corridor);
+        }
+
         //localization of nearest point on the footway
+        boost::mutex::scoped_lock localization_lock(*localization.getPositionMutex());
         localization.setPositionFromOdom(start.pose.position);
+        int sourceID = localization.getCurrentPosition()->id;
+        double sourceDistance = localization.checkDistance(sourceID, start.pose);
+        localization_lock.unlock();
+
+        boost::mutex::scoped_lock plan_lock(plan_mutex);
 
         //check target distance from footway
         localization.checkDistance(target.id, target.cartesianPoint.pose);
@@ -123,7 +303,7 @@ namespace osm_planner {
         double startGoalDist = sqrt(pow(dist_x, 2.0) + pow(dist_y, 2.0));
 
         //If distance between start and goal pose is lower as footway width then skip the planning on the osm map
-        if (startGoalDist <  localization.getFootwayWidth() + localization.checkDistance(localization.getCurrentPosition()->id, start.pose)){
+        if (startGoalDist <  localization.getFootwayWidth() + sourceDistance){
             plan.push_back(goal);
             path.poses.clear();
             path.poses.push_back(start);
@@ -141,13 +321,40 @@ namespace osm_planner {
         osm.publishPoint(goal.pose.position, Parser::TARGET_POSITION_MARKER, 1.0, goal.pose.orientation);
 
 
-       ///start planning, the Path is obtaining in global variable nav_msgs::Path path
-        int result = planning(localization.getCurrentPosition()->id, target.id);
+       ///start planning, the Path is saved in variable nav_msgs::Path path
+        std::vector<int> nodes;
+        nav_msgs::Path new_path;
+        std::vector<std::vector<int> > new_alternatives;
+        int result;
+        bool partial = false;
+
+        if (async_planning) {
+            result = asyncPlanning(sourceID, target.id, &nodes, &partial);
+            new_path = osm.getPath(nodes);
+        } else {
+            result = planning(sourceID, target.id, &nodes, &new_path, &new_alternatives);
+        }
 
         //check the result of planning
           if (result == osm_planner::newTarget::Response::NOT_INIT || result == osm_planner::newTarget::Response::PLAN_FAILED)
             return false;
 
+        //search didn't get anywhere before the deadline, use straight line to the goal
+        if (partial && nodes.size() < 2) {
+            plan.push_back(goal);
+            path.poses.clear();
+            path.poses.push_back(start);
+            path.poses.push_back(goal);
+            shortest_path_pub.publish(path);
+            return true;
+        }
+
+        solution = nodes;
+        alternatives = new_alternatives;
+        alternatives_version = osm.getGraphVersion();
+        path = new_path;
+        loadCorridor(solution);
+
         for (int i=1; i< path.poses.size(); i++){
 
             geometry_msgs::PoseStamped new_goal = goal;
@@ -178,30 +385,511 @@ namespace osm_planner {
             return osm_planner::newTarget::Response::NOT_INIT;
         }
 
+        boost::mutex::scoped_lock localization_lock(*localization.getPositionMutex());
         localization.updatePoseFromTF(); //update source point from TF
+        int sourceID = localization.getCurrentPosition()->id;
+        localization_lock.unlock();
+
+        if (tiles.isOpen()) {
+            std::vector<Parser::OSM_NODE> corridor;
+            Parser::OSM_NODE goal = {target_latitude, target_longitude, 0, 0};
+            corridor.push_back(osm.getNodeByID(sourceID));
+            corridor.push_back(goal);
+            loadCorridor(corridor);
+        }
 
-        //save new target point
-        target.geoPoint.latitude = target_latitude;
-        target.geoPoint.longitude = target_longitude;
-        target.id = osm.getNearestPoint(target_latitude, target_longitude);
-        target.cartesianPoint.pose.position.x =  osm.getCalculator()->getCoordinateX(target.geoPoint);
-        target.cartesianPoint.pose.position.y =  osm.getCalculator()->getCoordinateY(target.geoPoint);
-        target.cartesianPoint.pose.orientation = tf::createQuaternionMsgFromYaw( osm.getCalculator()->getBearing(target.geoPoint));
+        //new target point
+        POINT new_target;
+        new_target.geoPoint.latitude = target_latitude;
+        new_target.geoPoint.longitude = target_longitude;
+        new_target.id = osm.getNearestPoint(target_latitude, target_longitude);
+        new_target.cartesianPoint.pose.position.x =  osm.getCalculator()->getCoordinateX(new_target.geoPoint);
+        new_target.cartesianPoint.pose.position.y =  osm.getCalculator()->getCoordinateY(new_target.geoPoint);
+        new_target.cartesianPoint.pose.orientation = tf::createQuaternionMsgFromYaw( osm.getCalculator()->getBearing(new_target.geoPoint));
+
+        //checking distance to the nearest point
+        localization.checkDistance(new_target.id, new_target.geoPoint.latitude, new_target.geoPoint.longitude);
+
+        //searching runs in parallel with other requests
+        std::vector<int> nodes;
+        nav_msgs::Path new_path;
+        std::vector<std::vector<int> > new_alternatives;
+        int result = planning(sourceID, new_target.id, &nodes, &new_path, &new_alternatives);
+
+        //save new target point and path
+        boost::mutex::scoped_lock plan_lock(plan_mutex);
+        target = new_target;
 
         //draw target point
         osm.publishPoint(target_latitude, target_longitude, Parser::TARGET_POSITION_MARKER, 1.0, target.cartesianPoint.pose.orientation);
 
-        //checking distance to the nearest point
-        localization.checkDistance(target.id, target.geoPoint.latitude, target.geoPoint.longitude);
+        if (result == osm_planner::newTarget::Response::PLAN_OK) {
+            solution = nodes;
+            alternatives = new_alternatives;
+            alternatives_version = osm.getGraphVersion();
+            path = new_path;
+            loadCorridor(solution);
 
-       int result = planning(localization.getCurrentPosition()->id, target.id);
+            //add end (target) point
+            path.poses.push_back(target.cartesianPoint);
+            shortest_path_pub.publish(path);
+        }
+        return result;
+        }
 
-        //add end (target) point
-        path.poses.push_back(target.cartesianPoint);
+    //-------------------------------------------------------------//
+    //---------------MAKE PLAN through via points------------------//
+    //-------------------------------------------------------------//
+
+    int Planner::makeViaPlan(const std::vector<Parser::OSM_NODE> &waypoints, bool from_current_position,
+                             std::vector<double> *leg_distances, nav_msgs::Path *via_path) {
+
+        //Reference point is not initialize, please call init service
+        if (!localization.isInitialized()) {
+            return osm_planner::viaPoints::Response::NOT_INIT;
+        }
+
+        if (waypoints.empty() || (waypoints.size() < 2 && !from_current_position)) {
+            return osm_planner::viaPoints::Response::BAD_REQUEST;
+        }
+
+        if (tiles.isOpen()) {
+            std::vector<Parser::OSM_NODE> corridor;
+            if (from_current_position) {
+                boost::mutex::scoped_lock localization_lock(*localization.getPositionMutex());
+                corridor.push_back(osm.getNodeByID(localization.getCurrentPosition()->id));
+            }
+            corridor.insert(corridor.end(), waypoints.begin(), waypoints.end());
+            loadCorridor(corridor);
+        }
+
+        //all legs are planned on the same snapshot of the graph, even if the map is reloaded meanwhile
+        boost::shared_ptr<Parser::GRAPH> graph = osm.getGraph();
+
+        //all waypoints are snapped in one query
+        std::vector<int> ids;
+        {
+            Parser::GraphLock graph_lock(&osm, graph);
+            ids = osm.getNearestPoints(waypoints);
+        }
+
+        if (from_current_position) {
+            boost::mutex::scoped_lock localization_lock(*localization.getPositionMutex());
+            localization.updatePoseFromTF();
+            ids.insert(ids.begin(), localization.getCurrentPosition()->id);
+        }
+
+        ROS_INFO("OSM planner: Planning route through %d points...", (int) ids.size());
+
+        //legs share the workspaces and the route cache with other requests
+        int legs = ids.size() - 1;
+        std::vector<std::vector<int> > leg_nodes(legs);
+        std::vector<int> results(legs, osm_planner::newTarget::Response::PLAN_OK);
+        boost::atomic<int> next(0);
+
+        boost::thread_group group;
+        for (int i = 1; i < std::min(planner_threads, legs); i++) {
+            group.create_thread(boost::bind(&Planner::planLegs, this, graph, &ids, &leg_nodes, &results, &next));
+        }
+        planLegs(graph, &ids, &leg_nodes, &results, &next);
+        group.join_all();
+
+        Parser::GraphLock graph_lock(&osm, graph);
+        std::vector<int> nodes;
+        leg_distances->clear();
+
+        for (int i = 0; i < legs; i++) {
+
+            if (results[i] != osm_planner::newTarget::Response::PLAN_OK) {
+                ROS_ERROR("OSM planner: Leg %d of route failed", i);
+                return osm_planner::viaPoints::Response::PLAN_FAILED;
+            }
+
+            leg_distances->push_back(osm.getPathLength(leg_nodes[i]));
+
+            //the first node of the leg is the last node of the previous one
+            nodes.insert(nodes.end(), leg_nodes[i].begin() + (nodes.empty() ? 0 : 1), leg_nodes[i].end());
+        }
+
+        //new target is the last waypoint
+        POINT new_target;
+        new_target.geoPoint.latitude = waypoints.back().latitude;
+        new_target.geoPoint.longitude = waypoints.back().longitude;
+        new_target.id = ids.back();
+        new_target.cartesianPoint.pose.position.x = osm.getCalculator()->getCoordinateX(new_target.geoPoint);
+        new_target.cartesianPoint.pose.position.y = osm.getCalculator()->getCoordinateY(new_target.geoPoint);
+        new_target.cartesianPoint.pose.orientation = tf::createQuaternionMsgFromYaw(osm.getCalculator()->getBearing(new_target.geoPoint));
+
+        *via_path = osm.getPath(nodes);
+        via_path->poses.push_back(new_target.cartesianPoint);
+
+        //plan_mutex is taken before the lock of graph in cancelPoint(), so the graph is released first
+        graph_lock.unlock();
+
+        boost::mutex::scoped_lock plan_lock(plan_mutex);
+        target = new_target;
+        solution = nodes;
+        alternatives.clear();
+        path = *via_path;
+
+        osm.publishPoint(target.geoPoint.latitude, target.geoPoint.longitude, Parser::TARGET_POSITION_MARKER, 1.0, target.cartesianPoint.pose.orientation);
         shortest_path_pub.publish(path);
-        return result;
+
+        return osm_planner::viaPoints::Response::PLAN_OK;
+    }
+
+    void Planner::planLegs(boost::shared_ptr<Parser::GRAPH> graph, const std::vector<int> *ids, std::vector<std::vector<int> > *leg_nodes,
+                           std::vector<int> *results, boost::atomic<int> *next) {
+
+        //nested lock in planning() uses this snapshot
+        Parser::GraphLock graph_lock(&osm, graph);
+
+        for (int i = (*next)++; i < leg_nodes->size(); i = (*next)++) {
+            (*results)[i] = planning((*ids)[i], (*ids)[i + 1], &(*leg_nodes)[i]);
+        }
+    }
+
+    //-------------------------------------------------------------//
+    //-------DISTANCE MATRIX from geographics coordinates----------//
+    //-------------------------------------------------------------//
+
+    int Planner::makeDistanceMatrix(const std::vector<Parser::OSM_NODE> &sources, const std::vector<Parser::OSM_NODE> &targets,
+                                    std::vector<double> *distances, std::vector<nav_msgs::Path> *paths) {
+
+        //Reference point is not initialize, please call init service
+        if (!localization.isInitialized()) {
+            return osm_planner::distanceMatrix::Response::NOT_INIT;
+        }
+
+        ROS_INFO("OSM planner: Computing distance matrix %d x %d...", (int) sources.size(), (int) targets.size());
+        ros::Time start_time = ros::Time::now();
+
+        distances->assign(sources.size() * targets.size(), -1);
+        if (paths) {
+            paths->clear();
+            paths->resize(sources.size() * targets.size());
+        }
+
+        //the graph is undirected, so one search is needed for every point on the shorter side
+        bool transposed = targets.size() < sources.size();
+        const std::vector<Parser::OSM_NODE> &from = transposed ? targets : sources;
+        const std::vector<Parser::OSM_NODE> &to = transposed ? sources : targets;
+
+        //graph is locked before the workspace like in planning(), else threads waiting for the other one deadlock
+        Parser::GraphLock graph_lock(&osm);
+        Workspace dijkstra(&workspaces);
+
+        std::vector<int> toIDs(to.size());
+        for (int j = 0; j < to.size(); j++) {
+            toIDs[j] = osm.getNearestPoint(to[j].latitude, to[j].longitude);
+        }
+
+        //with all-pairs table every distance is one lookup, with hub labels merge of two labels
+        boost::shared_ptr<NextHopTable> table = getNextHopTable();
+        boost::shared_ptr<HubLabels> labels = table ? boost::shared_ptr<HubLabels>() : getHubLabels();
+
+        //shared graph has only adjacency lists
+        bool use_lists = osm.isSharedGraphAttached();
+        RadixHeapSearch &list_search = *dijkstra.getRadixHeapSearch();
+
+        for (int i = 0; i < from.size(); i++) {
+
+            int fromID = osm.getNearestPoint(from[i].latitude, from[i].longitude);
+            std::vector<float> row(to.size());
+
+            if (table) {
+                for (int j = 0; j < to.size(); j++) {
+                    row[j] = table->getDistance(fromID, toIDs[j]);
+                }
+            } else if (labels) {
+                for (int j = 0; j < to.size(); j++) {
+                    row[j] = labels->getDistance(fromID, toIDs[j]);
+                }
+            } else if (use_lists) {
+                list_search.findDistances(*osm.getIntegerGraph(), fromID);
+                for (int j = 0; j < to.size(); j++) {
+                    unsigned int distance = list_search.getDistance(toIDs[j]);
+                    if (distance == IntegerGraph::INFINITY_WEIGHT)
+                        row[j] = Dijkstra::INFINITY_DISTANCE;
+                    else
+                        row[j] = distance / INTEGER_GRAPH_SCALE;
+                }
+            } else {
+                row = dijkstra->findDistances(osm.getGraphOfVertex(), fromID, toIDs);
+            }
+
+            for (int j = 0; j < to.size(); j++) {
+
+                if (row[j] == Dijkstra::INFINITY_DISTANCE)
+                    continue;
+
+                int index = transposed ? j * targets.size() + i : i * targets.size() + j;
+                (*distances)[index] = row[j];
+
+                if (paths) {
+                    std::vector<int> nodes;
+                    if (table)
+                        nodes = table->getPath(fromID, toIDs[j]);
+                    else if (labels)
+                        nodes = labels->getPath(fromID, toIDs[j]);
+                    else if (use_lists) {
+                        for (int v = toIDs[j]; v != -1; v = list_search.getParents()[v]) {
+                            nodes.push_back(v);
+                        }
+                        std::reverse(nodes.begin(), nodes.end());
+                    } else
+                        nodes = dijkstra->getPathTo(toIDs[j]);
+                    if (transposed)
+                        std::reverse(nodes.begin(), nodes.end());
+                    (*paths)[index] = osm.getPath(nodes);
+                }
+            }
+        }
+
+        ROS_INFO("OSM planner: Time of distance matrix: %f ", (ros::Time::now() - start_time).toSec());
+        return osm_planner::distanceMatrix::Response::PLAN_OK;
+    }
+
+    //-------------------------------------------------------------//
+    //------------Reachable nodes within distance budget-----------//
+    //-------------------------------------------------------------//
+
+    int Planner::makeReachability(double latitude, double longitude, double max_distance, std::vector<int> *nodes,
+                                  std::vector<double> *distances, std::vector<nav_msgs::Path> *segments,
+                                  std::vector<Parser::OSM_NODE> *coordinates) {
+
+        //Reference point is not initialize, please call init service
+        if (!localization.isInitialized()) {
+            return osm_planner::reachability::Response::NOT_INIT;
+        }
+
+        if (max_distance < 0) {
+            return osm_planner::reachability::Response::BAD_REQUEST;
+        }
+
+        ROS_INFO("OSM planner: Computing reachability within %f m...", max_distance);
+        ros::Time start_time = ros::Time::now();
+
+        nodes->clear();
+        distances->clear();
+        if (segments)
+            segments->clear();
+        if (coordinates)
+            coordinates->clear();
+
+        //tiles change the graph under its exclusive lock, so they are loaded before the graph is locked
+        if (tiles.isOpen())
+            tiles.loadAround(latitude, longitude, max_distance);
+
+        Parser::GraphLock graph_lock(&osm);
+
+        int sourceID = osm.getNearestPoint(latitude, longitude);
+        const IntegerGraph &graph = *osm.getIntegerGraph();
+
+        //budget in centimetres, clamped to the range of weights
+        double budget = std::min(max_distance * INTEGER_GRAPH_SCALE, (double) IntegerGraph::INFINITY_WEIGHT - 1);
+
+        DeltaStepping search(reachability_threads, std::max(1.0, delta_stepping_bucket * INTEGER_GRAPH_SCALE));
+        search.findDistances(graph, sourceID, (unsigned int) budget);
+        const std::vector<unsigned int> &distance = search.getDistances();
+
+        for (int u = 0; u < distance.size(); u++) {
+
+            if (distance[u] == IntegerGraph::INFINITY_WEIGHT)
+                continue;
+
+            nodes->push_back(u);
+            distances->push_back(distance[u] / INTEGER_GRAPH_SCALE);
+            if (coordinates)
+                coordinates->push_back(osm.getNodeByID(u));
+
+            if (!segments)
+                continue;
+
+            //every edge only once
+            for (int e = graph.begin(u); e < graph.end(u); e++) {
+                int v = graph.target(e);
+                if (u < v && graph.weight(e) != IntegerGraph::INFINITY_WEIGHT && distance[v] != IntegerGraph::INFINITY_WEIGHT) {
+                    std::vector<int> segment(2);
+                    segment[0] = u;
+                    segment[1] = v;
+                    segments->push_back(osm.getPath(segment));
+                }
+            }
+        }
+
+        ROS_INFO("OSM planner: Reachable %d nodes, time: %f ", (int) nodes->size(), (ros::Time::now() - start_time).toSec());
+        return osm_planner::reachability::Response::PLAN_OK;
+    }
+
+    //-------------------------------------------------------------//
+    //------------------Hot reload of the map----------------------//
+    //-------------------------------------------------------------//
+
+    int Planner::reloadMap(std::string file, bool wait) {
+
+        boost::mutex::scoped_lock lock(reload_mutex);
+
+        if (reloading) {
+            return osm_planner::reloadMap::Response::BUSY;
+        }
+
+        if (reload_thread)
+            reload_thread->join();
+
+        if (tiles.isOpen()) {
+            ROS_ERROR("OSM planner: Map is loaded by tiles, compile the new map by map_tiler");
+            return osm_planner::reloadMap::Response::RELOAD_FAILED;
+        }
+
+        if (osm.isSharedGraphAttached()) {
+            ROS_ERROR("OSM planner: Graph is attached from shared memory, reload the map in its publisher");
+            return osm_planner::reloadMap::Response::RELOAD_FAILED;
+        }
+
+        if (file.empty())
+            file = map_file;
+
+        ROS_INFO("OSM planner: Reloading map %s...", file.c_str());
+
+        reloading = true;
+        boost::shared_ptr<boost::thread> thread(new boost::thread(&Planner::reloadMapThread, this, file));
+        reload_thread = thread;
+        lock.unlock();
+
+        if (!wait)
+            return osm_planner::reloadMap::Response::RELOAD_OK;
+
+        thread->join();
+        lock.lock();
+        return reload_result;
+    }
+
+    //runs in background thread, the old graph is used until parse() swaps in the new one
+    void Planner::reloadMapThread(std::string file) {
+
+        int result = osm_planner::reloadMap::Response::RELOAD_OK;
+
+        try {
+            osm.setNewMap(file);
+            osm.parse();
+
+        } catch (std::runtime_error &e) {
+            ROS_ERROR("OSM planner: Reload of map failed, the old map is used");
+            osm.setNewMap(map_file);
+            result = osm_planner::reloadMap::Response::RELOAD_FAILED;
+        }
+
+        if (result == osm_planner::reloadMap::Response::RELOAD_OK) {
+
+            {
+                boost::mutex::scoped_lock landmarks_lock(landmarks_mutex);
+                if (landmarks_file == map_file + ".landmarks")
+                    landmarks_file = file + ".landmarks";
+            }
+            resetPlan();
+
+            ROS_INFO("OSM planner: Map %s was reloaded, %d nodes", file.c_str(), (int) osm.getIntegerGraph()->size());
+        }
+
+        boost::mutex::scoped_lock lock(reload_mutex);
+        if (result == osm_planner::reloadMap::Response::RELOAD_OK)
+            map_file = file;
+        reload_result = result;
+        reloading = false;
+    }
+
+    //-------------------------------------------------------------//
+    //---------------Update of map from OsmChange------------------//
+    //-------------------------------------------------------------//
+
+    int Planner::applyMapChange(std::string file, int *changed_ways) {
+
+        //changed ways would be overwritten by the next loading of their tiles
+        if (tiles.isOpen()) {
+            ROS_ERROR("OSM planner: Map is loaded by tiles, compile the changed map by map_tiler");
+            return osm_planner::applyMapChange::Response::CHANGE_FAILED;
+        }
+
+        try {
+            *changed_ways = osm.applyChange(file);
+
+        } catch (std::runtime_error &e) {
+            return osm_planner::applyMapChange::Response::CHANGE_FAILED;
+        }
+
+        resetPlan();
+        return osm_planner::applyMapChange::Response::CHANGE_OK;
+    }
+
+    void Planner::loadCorridor(const std::vector<Parser::OSM_NODE> &points) {
+
+        if (tiles.isOpen())
+            tiles.loadCorridor(points, tiles_corridor_radius);
+    }
+
+    //tiles of the current route stay loaded, until the next route is planned
+    void Planner::loadCorridor(const std::vector<int> &nodes) {
+
+        if (!tiles.isOpen())
+            return;
+
+        std::vector<Parser::OSM_NODE> points;
+        {
+            Parser::GraphLock graph_lock(&osm);
+            for (int i = 0; i < nodes.size(); i++) {
+                points.push_back(osm.getNodeByID(nodes[i]));
+            }
+        }
+        tiles.loadCorridor(points, tiles_corridor_radius);
+    }
+
+    int Planner::setFilterOfWays(std::vector<std::string> types, int *ways) {
+
+        //tiles contain only the ways of filter used by map_tiler
+        if (tiles.isOpen()) {
+            ROS_ERROR("OSM planner: Map is loaded by tiles, compile the map with the new filter by map_tiler");
+            return osm_planner::setFilterOfWays::Response::FILTER_FAILED;
+        }
+
+        try {
+            osm.filterWays(types);
+
+        } catch (std::runtime_error &e) {
+            return osm_planner::setFilterOfWays::Response::FILTER_FAILED;
+        }
+
+        {
+            Parser::GraphLock graph_lock(&osm);
+            *ways = osm.getGraph()->ways.size();
+        }
+
+        resetPlan();
+        return osm_planner::setFilterOfWays::Response::FILTER_OK;
+    }
+
+    //nodes of the current plan can be removed by the change of map, so they are snapped again
+    void Planner::resetPlan() {
+
+        //lower bounds of landmarks are valid only for the graph, which they were computed on
+        {
+            boost::mutex::scoped_lock landmarks_lock(landmarks_mutex);
+            landmarks.reset();
         }
 
+        {
+            boost::mutex::scoped_lock localization_lock(*localization.getPositionMutex());
+            Parser::OSM_NODE position = localization.getCurrentPosition()->geoPoint;
+            localization.getCurrentPosition()->id = osm.getNearestPoint(position.latitude, position.longitude);
+        }
+
+        boost::mutex::scoped_lock plan_lock(plan_mutex);
+        target.id = osm.getNearestPoint(target.geoPoint.latitude, target.geoPoint.longitude);
+        solution.clear();
+        alternatives.clear();
+        path.poses.clear();
+    }
+
     /*--------------------PROTECTED FUNCTIONS---------------------*/
 
 
@@ -209,7 +897,8 @@ namespace osm_planner {
     //-----------------MAKE PLAN from osm id's---------------------//
     //-------------------------------------------------------------//
 
-    int Planner::planning(int sourceID, int targetID) {
+    int Planner::planning(int sourceID, int targetID, std::vector<int> *nodes, nav_msgs::Path *path,
+                          std::vector<std::vector<int> > *alternatives) {
 
         //Reference point is not initialize, please call init service
         if (!localization.isInitialized()) {
@@ -219,8 +908,68 @@ namespace osm_planner {
         ROS_INFO("OSM planner: Planning trajectory...");
         ros::Time start_time = ros::Time::now();
 
+        RouteCache::ROUTE route;
+
         try {
-            path = osm.getPath(dijkstra.findShortestPath(osm.getGraphOfVertex(), sourceID, targetID));
+            //shared access to the graph, so other requests can plan at the same time
+            Parser::GraphLock graph_lock(&osm);
+            unsigned long version = osm.getGraphVersion();
+
+            //IDs snapped before reload of the map can be out of the new graph
+            int size = osm.getIntegerGraph()->size();
+            if (sourceID < 0 || sourceID >= size || targetID < 0 || targetID >= size)
+                throw dijkstra_exception(dijkstra_exception::NO_PATH_FOUND);
+
+            if (route_cache.get(sourceID, targetID, version, &route)) {
+                ROS_INFO("OSM planner: Route was found in cache (hits %lu, misses %lu)", route_cache.getHits(), route_cache.getMisses());
+
+            } else {
+                boost::shared_ptr<NextHopTable> table = getNextHopTable();
+                boost::shared_ptr<HubLabels> labels = table ? boost::shared_ptr<HubLabels>() : getHubLabels();
+
+                if (alternative_routes > 0) {
+                    //shortest path and alternatives from the same two search trees
+                    AlternativeRoutes generator(alternative_routes, alternative_max_stretch, alternative_max_share);
+                    std::vector<std::vector<int> > routes = generator.findRoutes(*osm.getIntegerGraph(), sourceID, targetID);
+                    route.nodes = routes[0];
+                    route.alternatives.assign(routes.begin() + 1, routes.end());
+
+                } else if (table) {
+                    //walk over all-pairs table
+                    route.nodes = table->getPath(sourceID, targetID);
+                    if (route.nodes.empty())
+                        throw dijkstra_exception(dijkstra_exception::NO_PATH_FOUND);
+
+                } else if (labels) {
+                    //query without graph search
+                    route.nodes = labels->getPath(sourceID, targetID);
+                    if (route.nodes.empty())
+                        throw dijkstra_exception(dijkstra_exception::NO_PATH_FOUND);
+
+                } else if (search_kernel == "radix_heap") {
+                    Workspace workspace(&workspaces);
+                    route.nodes = workspace.getRadixHeapSearch()->findShortestPath(*osm.getIntegerGraph(), sourceID, targetID);
+
+                } else if (search_kernel == "bucket") {
+                    Workspace workspace(&workspaces);
+                    route.nodes = workspace.getBucketSearch()->findShortestPath(*osm.getIntegerGraph(), sourceID, targetID);
+
+                } else {
+                    std::vector<float> heuristic;
+                    if (use_astar)
+                        getHeuristic(targetID, &heuristic);
+
+                    //every running search has own workspace
+                    Workspace dijkstra(&workspaces);
+                    route.nodes = dijkstra->findShortestPath(osm.getGraphOfVertex(), sourceID, targetID, use_astar ? &heuristic : NULL);
+                }
+
+                route.hasPath = route_cache_paths;
+                if (route.hasPath)
+                    route.path = osm.getPath(route.nodes);
+
+                route_cache.put(sourceID, targetID, version, route);
+            }
 
             ROS_INFO("OSM planner: Time of planning: %f ", (ros::Time::now() - start_time).toSec());
 
@@ -231,9 +980,297 @@ namespace osm_planner {
                 ROS_ERROR("OSM planner: Undefined error");
             return osm_planner::newTarget::Response::PLAN_FAILED;
         }
+
+        *nodes = route.nodes;
+        if (alternatives)
+            *alternatives = route.alternatives;
+        if (path) {
+            if (route.hasPath) {
+                *path = route.path;
+                path->header.stamp = ros::Time::now();
+            } else {
+                *path = osm.getPath(route.nodes);
+            }
+        }
         return osm_planner::newTarget::Response::PLAN_OK;
     }
 
+    //-------------------------------------------------------------//
+    //-----------MAKE PLAN in background with deadline-------------//
+    //-------------------------------------------------------------//
+
+    int Planner::asyncPlanning(int sourceID, int targetID, std::vector<int> *nodes, bool *partial) {
+
+        //Reference point is not initialize, please call init service
+        if (!localization.isInitialized()) {
+            return osm_planner::newTarget::Response::NOT_INIT;
+        }
+
+        //waiting for the previous search is counted in the deadline too
+        boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds((long) (planning_deadline * 1000));
+
+        boost::mutex::scoped_lock lock(async_mutex);
+
+        //background search runs on this snapshot, even if the map is reloaded meanwhile
+        boost::shared_ptr<Parser::GRAPH> graph = osm.getGraph();
+        unsigned long version = graph->version;
+
+        //running or finished search for the same request is reused, else the new search is started
+        if (!async_thread || async_source != sourceID || async_target != targetID || async_version != version) {
+
+            cancelAsyncSearch(lock);
+
+            //estimated distance to the goal for every node - the best partial path leads to the nearest one
+            {
+                Parser::GraphLock graph_lock(&osm, graph);
+
+                //IDs snapped before reload of the map can be out of the new graph
+                int size = osm.getIntegerGraph()->size();
+                if (sourceID < 0 || sourceID >= size || targetID < 0 || targetID >= size) {
+                    ROS_ERROR("OSM planner: Make plan failed...");
+                    return osm_planner::newTarget::Response::PLAN_FAILED;
+                }
+                getHeuristic(targetID, &async_heuristic);
+            }
+            async_dijkstra.setGoalDistance(async_heuristic);
+            async_dijkstra.setCancelled(false);
+
+            async_source = sourceID;
+            async_target = targetID;
+            async_version = version;
+            async_running = true;
+            async_thread = boost::shared_ptr<boost::thread>(new boost::thread(&Planner::asyncSearch, this, graph, sourceID, targetID));
+        }
+
+        while (async_running) {
+            if (!async_finished.timed_wait(lock, deadline))
+                break;
+        }
+
+        if (!async_running) {
+            *partial = false;
+            *nodes = async_nodes;
+            return async_result;
+        }
+
+        //search still runs, it can be finished in the next call with the same goal
+        *partial = true;
+        *nodes = async_dijkstra.getPartialSolution();
+        ROS_WARN("OSM planner: Planning deadline %f s was exceeded, using partial path with %d nodes", planning_deadline, (int) nodes->size());
+        return osm_planner::newTarget::Response::PLAN_OK;
+    }
+
+    //runs in background thread
+    void Planner::asyncSearch(boost::shared_ptr<Parser::GRAPH> graph, int sourceID, int targetID) {
+
+        std::vector<int> nodes;
+        int result = osm_planner::newTarget::Response::PLAN_OK;
+
+        ros::Time start_time = ros::Time::now();
+
+        try {
+            Parser::GraphLock graph_lock(&osm, graph);
+            nodes = async_dijkstra.findShortestPath(osm.getGraphOfVertex(), sourceID, targetID, use_astar ? &async_heuristic : NULL);
+            ROS_INFO("OSM planner: Time of background planning: %f ", (ros::Time::now() - start_time).toSec());
+
+        } catch (dijkstra_exception &e) {
+            if (e.get_err_id() == dijkstra_exception::NO_PATH_FOUND)
+                ROS_ERROR("OSM planner: Make plan failed...");
+            result = osm_planner::newTarget::Response::PLAN_FAILED;
+        }
+
+        boost::mutex::scoped_lock lock(async_mutex);
+        async_nodes = nodes;
+        async_result = result;
+        async_running = false;
+        async_finished.notify_all();
+    }
+
+    //lock of async_mutex is released while waiting for the end of search
+    void Planner::cancelAsyncSearch(boost::mutex::scoped_lock &lock) {
+
+        if (!async_thread)
+            return;
+
+        async_dijkstra.setCancelled(true);
+        while (async_running) {
+            async_finished.wait(lock);
+        }
+        async_thread->join();
+        async_thread.reset();
+    }
+
+    //-------------------------------------------------------------//
+    //---------------A* heuristic with landmarks-------------------//
+    //-------------------------------------------------------------//
+
+    //landmarks are loaded from file or computed in background, geodesic heuristic is used until they are ready,
+    //shared lock of graph must be held
+    boost::shared_ptr<Landmarks> Planner::getLandmarks() {
+
+        boost::mutex::scoped_lock lock(landmarks_mutex);
+
+        if (landmarks_count <= 0)
+            return boost::shared_ptr<Landmarks>();
+
+        //deleted edges only lengthen distances, so the bounds stay admissible until ways are changed
+        if (landmarks && landmarks->isReady(osm.getStructureVersion()))
+            return landmarks;
+
+        if (!landmarks_building) {
+            if (landmarks_thread)
+                landmarks_thread->join();
+
+            landmarks_building = true;
+            landmarks_thread = boost::shared_ptr<boost::thread>(new boost::thread(&Planner::buildLandmarks, this));
+        }
+        return boost::shared_ptr<Landmarks>();
+    }
+
+    //runs in background thread
+    void Planner::buildLandmarks() {
+
+        boost::mutex::scoped_lock lock(landmarks_mutex);
+        std::string file = landmarks_file;
+        lock.unlock();
+
+        Parser::GraphLock graph_lock(&osm);
+        unsigned long version = osm.getStructureVersion();
+        bool deleted_edges = osm.getGraphVersion() != version;
+
+        boost::shared_ptr<Landmarks> new_landmarks(new Landmarks());
+
+        if (new_landmarks->load(file, osm.getGraphOfVertex(), version)) {
+            ROS_INFO("OSM planner: Loaded %d landmarks from %s", new_landmarks->getCount(), file.c_str());
+
+        } else {
+            ros::Time start_time = ros::Time::now();
+            new_landmarks->build(osm.getGraphOfVertex(), landmarks_count, version);
+            ROS_INFO("OSM planner: Computed %d landmarks, time: %f", new_landmarks->getCount(), (ros::Time::now() - start_time).toSec());
+
+            //tables of graph with refused edges wouldn't match the map on the next start
+            if (!deleted_edges && !new_landmarks->save(file))
+                ROS_WARN("OSM planner: Can't save landmarks to %s", file.c_str());
+        }
+        graph_lock.unlock();
+
+        lock.lock();
+        landmarks = new_landmarks;
+        landmarks_building = false;
+    }
+
+    //lower bound of distance to the target for every node
+    void Planner::getHeuristic(int targetID, std::vector<float> *heuristic) {
+
+        int size = osm.getIntegerGraph()->size();
+        Parser::OSM_NODE goal = osm.getNodeByID(targetID);
+
+        heuristic->resize(size);
+        for (int i = 0; i < size; i++) {
+            (*heuristic)[i] = Parser::Haversine::getDistance(osm.getNodeByID(i), goal);
+        }
+
+        //landmarks are used only by A*, goal distance of partial path is geodesic
+        boost::shared_ptr<Landmarks> current = use_astar ? getLandmarks() : boost::shared_ptr<Landmarks>();
+        if (!current)
+            return;
+
+        std::vector<float> bounds;
+        current->getLowerBounds(targetID, &bounds);
+        for (int i = 0; i < size; i++) {
+            if (bounds[i] > (*heuristic)[i])
+                (*heuristic)[i] = bounds[i];
+        }
+    }
+
+    //-------------------------------------------------------------//
+    //------------------------Hub labels---------------------------//
+    //-------------------------------------------------------------//
+
+    boost::shared_ptr<HubLabels> Planner::getHubLabels() {
+
+        boost::mutex::scoped_lock lock(hub_labels_mutex);
+
+        if (!use_hub_labels || osm.getIntegerGraph()->size() > hub_labels_max_nodes)
+            return boost::shared_ptr<HubLabels>();
+
+        if (hub_labels && hub_labels->isReady(osm.getGraphVersion()))
+            return hub_labels;
+
+        //labels are old, searching is used until new labels are built
+        if (!hub_labels_building) {
+            if (hub_labels_thread)
+                hub_labels_thread->join();
+
+            hub_labels_building = true;
+            hub_labels_thread = boost::shared_ptr<boost::thread>(new boost::thread(&Planner::buildHubLabels, this));
+        }
+        return boost::shared_ptr<HubLabels>();
+    }
+
+    //runs in background thread
+    void Planner::buildHubLabels() {
+
+        ros::Time start_time = ros::Time::now();
+
+        Parser::GraphLock graph_lock(&osm);
+        unsigned long version = osm.getGraphVersion();
+
+        boost::shared_ptr<HubLabels> labels(new HubLabels());
+        labels->build(osm.getGraphOfVertex(), version);
+        graph_lock.unlock();
+
+        ROS_INFO("OSM planner: Hub labels were built, %ld entries, time: %f", labels->getLabelsSize(), (ros::Time::now() - start_time).toSec());
+
+        boost::mutex::scoped_lock lock(hub_labels_mutex);
+        hub_labels = labels;
+        hub_labels_building = false;
+    }
+
+    //-------------------------------------------------------------//
+    //--------------------All-pairs table--------------------------//
+    //-------------------------------------------------------------//
+
+    boost::shared_ptr<NextHopTable> Planner::getNextHopTable() {
+
+        boost::mutex::scoped_lock lock(next_hop_table_mutex);
+
+        if (all_pairs_max_nodes <= 0 || osm.getIntegerGraph()->size() > all_pairs_max_nodes)
+            return boost::shared_ptr<NextHopTable>();
+
+        if (next_hop_table && next_hop_table->isReady(osm.getGraphVersion()))
+            return next_hop_table;
+
+        //table is old, searching is used until new table is built
+        if (!next_hop_table_building) {
+            if (next_hop_table_thread)
+                next_hop_table_thread->join();
+
+            next_hop_table_building = true;
+            next_hop_table_thread = boost::shared_ptr<boost::thread>(new boost::thread(&Planner::buildNextHopTable, this));
+        }
+        return boost::shared_ptr<NextHopTable>();
+    }
+
+    //runs in background thread
+    void Planner::buildNextHopTable() {
+
+        ros::Time start_time = ros::Time::now();
+
+        Parser::GraphLock graph_lock(&osm);
+        unsigned long version = osm.getGraphVersion();
+
+        boost::shared_ptr<NextHopTable> table(new NextHopTable());
+        table->build(*osm.getIntegerGraph(), version, boost::thread::hardware_concurrency());
+        graph_lock.unlock();
+
+        ROS_INFO("OSM planner: All-pairs table was built, %ld bytes, time: %f", table->getMemory(), (ros::Time::now() - start_time).toSec());
+
+        boost::mutex::scoped_lock lock(next_hop_table_mutex);
+        next_hop_table = table;
+        next_hop_table_building = false;
+    }
+
     //-------------------------------------------------------------//
     //-------------Refuse point and make plan again----------------//
     //-------------------------------------------------------------//
@@ -245,8 +1282,10 @@ namespace osm_planner {
             return osm_planner::cancelledPoint::Response::NOT_INIT;
         }
 
+        boost::mutex::scoped_lock plan_lock(plan_mutex);
+
         //get current shortest path - vector of osm nodes IDs
-        std::vector<int> path = dijkstra.getSolution();
+        std::vector<int> path = solution;
 
         //if index is greater than array size
         if (pointID >= path.size()) {
@@ -259,31 +1298,77 @@ namespace osm_planner {
         refused_path[1] = path[pointID + 1];
         osm.publishRefusedPath(refused_path);
 
-        //delete edge between two osm nodes
+        //delete edge between two osm nodes, alternatives of the graph before this change are kept,
+        //their edges are checked in useAlternative()
+        unsigned long version = osm.getGraphVersion();
         osm.deleteEdgeOnGraph(path[pointID], path[pointID + 1]);
+        if (alternatives_version == version)
+            alternatives_version = osm.getGraphVersion();
 
         //planning shorest path
+        boost::mutex::scoped_lock localization_lock(*localization.getPositionMutex());
         if (!localization.updatePoseFromTF()) {     //update source position from TF
             localization.getCurrentPosition()->id = path[pointID];   //if source can not update from TF, return back to last position
         }
+        int sourceID = localization.getCurrentPosition()->id;
+        localization_lock.unlock();
 
-        try {
-
-            this->path = osm.getPath(dijkstra.findShortestPath(osm.getGraphOfVertex(), localization.getCurrentPosition()->id, target.id));
-            this->path.poses.push_back(target.cartesianPoint);
-            shortest_path_pub.publish(this->path);
+        std::vector<int> nodes;
+        if (useAlternative(sourceID, &nodes)) {
+            ROS_INFO("OSM planner: Switched to precomputed alternative route");
+            this->path = osm.getPath(nodes);
 
-        } catch (dijkstra_exception &e) {
-            if (e.get_err_id() == dijkstra_exception::NO_PATH_FOUND) {
-                ROS_ERROR("OSM planner: Make plan failed");
-            } else
-                ROS_ERROR("OSM planner: Undefined error");
+        } else if (planning(sourceID, target.id, &nodes, &this->path, &alternatives) != osm_planner::newTarget::Response::PLAN_OK) {
+            alternatives.clear();
             return osm_planner::cancelledPoint::Response::PLAN_FAILED;
+
+        } else {
+            alternatives_version = osm.getGraphVersion();
         }
 
+        solution = nodes;
+        this->path.poses.push_back(target.cartesianPoint);
+        shortest_path_pub.publish(this->path);
+
         return osm_planner::newTarget::Response::PLAN_OK;
     }
 
+    bool Planner::useAlternative(int sourceID, std::vector<int> *nodes) {
+
+        //node IDs and edges of other graph aren't valid
+        Parser::GraphLock graph_lock(&osm);
+        if (alternatives_version != osm.getGraphVersion()) {
+            alternatives.clear();
+            return false;
+        }
+
+        const IntegerGraph &graph = *osm.getIntegerGraph();
+        for (int i = 0; i < alternatives.size(); i++) {
+
+            //robot has to be on the alternative, only the remaining part of it is checked
+            std::vector<int> &route = alternatives[i];
+            std::vector<int>::iterator start = std::find(route.begin(), route.end(), sourceID);
+            if (start == route.end())
+                continue;
+
+            //every edge must still be in the graph, also edges deleted by older cancelPoint() calls
+            bool open = true;
+            for (std::vector<int>::iterator it = start; it + 1 < route.end() && open; it++) {
+                open = false;
+                for (int e = graph.begin(*it); e < graph.end(*it) && !open; e++) {
+                    open = graph.target(e) == *(it + 1) && graph.weight(e) != IntegerGraph::INFINITY_WEIGHT;
+                }
+            }
+
+            if (open) {
+                nodes->assign(start, route.end());
+                alternatives.erase(alternatives.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
     //-------------------------------------------------------------//
     //-------------------------------------------------------------//
 
@@ -299,9 +1384,109 @@ namespace osm_planner {
     bool Planner::drawingRouteCallback(std_srvs::Empty::Request &req, std_srvs::Empty::Response &res){
 
         osm.publishRouteNetwork();
+
+        boost::mutex::scoped_lock plan_lock(plan_mutex);
         shortest_path_pub.publish(path);
         return true;
     }
 
-}
+    bool Planner::distanceMatrixCallback(osm_planner::distanceMatrix::Request &req, osm_planner::distanceMatrix::Response &res){
+
+        if (req.source_latitudes.size() != req.source_longitudes.size() || req.target_latitudes.size() != req.target_longitudes.size()) {
+            res.result = osm_planner::distanceMatrix::Response::BAD_REQUEST;
+            return true;
+        }
+
+        std::vector<Parser::OSM_NODE> sources(req.source_latitudes.size());
+        for (int i = 0; i < sources.size(); i++) {
+            sources[i].latitude = req.source_latitudes[i];
+            sources[i].longitude = req.source_longitudes[i];
+        }
+
+        std::vector<Parser::OSM_NODE> targets(req.target_latitudes.size());
+        for (int i = 0; i < targets.size(); i++) {
+            targets[i].latitude = req.target_latitudes[i];
+            targets[i].longitude = req.target_longitudes[i];
+        }
+
+        res.rows = sources.size();
+        res.cols = targets.size();
+        res.result = makeDistanceMatrix(sources, targets, &res.distances, req.return_paths ? &res.paths : NULL);
+        return true;
+    }
+
+    bool Planner::routeCacheStatsCallback(osm_planner::routeCacheStats::Request &req, osm_planner::routeCacheStats::Response &res){
+
+        res.hits = route_cache.getHits();
+        res.misses = route_cache.getMisses();
+        res.entries = route_cache.size();
+        res.max_entries = route_cache.getMaxEntries();
+        return true;
+    }
+
+    bool Planner::viaPointsCallback(osm_planner::viaPoints::Request &req, osm_planner::viaPoints::Response &res){
+
+        if (req.latitudes.size() != req.longitudes.size()) {
+            res.result = osm_planner::viaPoints::Response::BAD_REQUEST;
+            return true;
+        }
+
+        std::vector<Parser::OSM_NODE> waypoints(req.latitudes.size());
+        for (int i = 0; i < waypoints.size(); i++) {
+            waypoints[i].latitude = req.latitudes[i];
+            waypoints[i].longitude = req.longitudes[i];
+        }
+
+        res.result = makeViaPlan(waypoints, req.from_current_position, &res.leg_distances, &res.path);
+
+        res.distance = 0;
+        for (int i = 0; i < res.leg_distances.size(); i++) {
+            res.distance += res.leg_distances[i];
+        }
+        return true;
+    }
+
+    bool Planner::reachabilityCallback(osm_planner::reachability::Request &req, osm_planner::reachability::Response &res){
+
+        std::vector<Parser::OSM_NODE> coordinates;
+        res.result = makeReachability(req.latitude, req.longitude, req.max_distance, &res.nodes, &res.distances,
+                                      req.return_segments ? &res.segments : NULL, &coordinates);
+
+        for (int i = 0; i < coordinates.size(); i++) {
+            res.latitudes.push_back(coordinates[i].latitude);
+            res.longitudes.push_back(coordinates[i].longitude);
+        }
+        return true;
+    }
+
+    bool Planner::reloadMapCallback(osm_planner::reloadMap::Request &req, osm_planner::reloadMap::Response &res){
+
+        res.result = reloadMap(req.osm_map_path, req.wait);
+        res.version = osm.getGraphVersion();
+        return true;
+    }
 
+    bool Planner::applyMapChangeCallback(osm_planner::applyMapChange::Request &req, osm_planner::applyMapChange::Response &res){
+
+        res.changed_ways = 0;
+        res.result = applyMapChange(req.osc_path, &res.changed_ways);
+        res.version = osm.getGraphVersion();
+        return true;
+    }
+
+    bool Planner::setFilterOfWaysCallback(osm_planner::setFilterOfWays::Request &req, osm_planner::setFilterOfWays::Response &res){
+
+        res.ways = 0;
+        res.result = setFilterOfWays(req.filter_of_ways, &res.ways);
+        res.version = osm.getGraphVersion();
+        return true;
+    }
+
+    void Planner::sharedGraphCallback(const ros::TimerEvent &event) {
+
+        //points snapped on the old graph and its plans aren't valid
+        if (osm.updateSharedGraph())
+            resetPlan();
+    }
+
+}
@@ -6,28 +6,41 @@
  */
 
 #include <osm_planner/osm_planner.h>
+#include <osm_planner/executor.h>
 #include <nav_msgs/Odometry.h>
 
 class OsmPlannerNode: osm_planner::Planner{
 public:
 
-    OsmPlannerNode() : osm_planner::Planner(){
+    OsmPlannerNode(osm_planner::Executor *executor) : osm_planner::Planner(executor), executor(executor){
 
-        //init ros topics and services
+        //init ros topics and services - odom and pose updates are in localization queue
         ros::NodeHandle n;
+        n.setCallbackQueue(executor->getLocalizationQueue());
 
         odom_sub = n.subscribe("odom", 1, &OsmPlannerNode::odometryCallback, this);
 
-        //services
-        plan_service = n.advertiseService("make_plan", &OsmPlannerNode::makePlanCallback, this);
+        //pose is updated from tf by timer, 0 - only from odom and gps
+        double pose_update_rate;
+        this->n.param<double>("pose_update_rate", pose_update_rate, 10.0);
+        if (pose_update_rate > 0)
+            pose_timer = n.createTimer(ros::Duration(1.0 / pose_update_rate), &OsmPlannerNode::poseTimerCallback, this);
+
+        //services - planning requests have own queue and pool of threads, so slow plan doesn't stall gps and odom callbacks
+        ros::NodeHandle plan_n;
+        plan_n.setCallbackQueue(executor->getPlanningQueue());
+        plan_service = plan_n.advertiseService("make_plan", &OsmPlannerNode::makePlanCallback, this);
     }
 
-    void update(){
-        localization.updatePoseFromTF();
+    void start(){
+        executor->start(planner_threads);
+        ROS_INFO("OSM planner: Serving make_plan on %d threads", planner_threads);
     }
 
 private:
 
+    osm_planner::Executor *executor;
+
     /* Subscribers */
     ros::Subscriber gps_sub;
     ros::Subscriber odom_sub;
@@ -35,6 +48,13 @@ private:
     /* Services */
     ros::ServiceServer plan_service;
 
+    ros::Timer pose_timer;
+
+    void poseTimerCallback(const ros::TimerEvent &event){
+        boost::mutex::scoped_lock lock(*localization.getPositionMutex());
+        localization.updatePoseFromTF();
+    }
+
 
     bool makePlanCallback(osm_planner::newTarget::Request &req, osm_planner::newTarget::Response &res) {
 
@@ -44,6 +64,7 @@ private:
 
     void odometryCallback(const nav_msgs::Odometry::ConstPtr& msg) {
 
+        boost::mutex::scoped_lock lock(*localization.getPositionMutex());
         localization.setPositionFromOdom(msg->pose.pose.position);
     }
 
@@ -53,15 +74,13 @@ int main(int argc, char **argv) {
 
 	ros::init(argc, argv, "test_osm");
 
-    OsmPlannerNode osm_planner;
-
-    ros::Rate rate(2);
+    //callbacks of node are in queues of executor, the global queue is spun by this thread
+    osm_planner::Executor executor;
+    OsmPlannerNode osm_planner(&executor);
 
-    while (ros::ok()) {
-
-        osm_planner.update();
-        ros::spinOnce();
-    }
+    osm_planner.start();
+    ros::spin();
+    executor.stop();
 
 return 0;
 }
@@ -0,0 +1,94 @@
+/*
+ * planner_benchmark.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: michal
+ */
+
+#include <osm_planner/osm_parser.h>
+#include <osm_planner/workspace_pool.h>
+
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+
+//Throughput of parallel planning - random plans are solved by 1, 2, 4 ... threads on one shared graph
+
+typedef struct query {
+    int source;
+    int target;
+} QUERY;
+
+void worker(osm_planner::Parser *map, osm_planner::WorkspacePool *pool, std::vector<QUERY> *queries, boost::atomic<int> *next) {
+
+    for (int i = (*next)++; i < queries->size(); i = (*next)++) {
+
+        osm_planner::Parser::GraphLock lock(map);
+        osm_planner::Workspace dijkstra(pool);
+
+        try {
+            dijkstra->findShortestPath(map->getGraphOfVertex(), (*queries)[i].source, (*queries)[i].target);
+        } catch (osm_planner::dijkstra_exception &e) {
+            //unreachable target costs the same work as found path
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+
+    ros::init(argc, argv, "planner_benchmark");
+    ros::NodeHandle n("~");
+
+    std::string file = "skuska.osm";
+    n.getParam("osm_map_path", file);
+
+    std::vector<std::string> types_of_ways;
+    n.getParam("filter_of_ways", types_of_ways);
+
+    double interpolation_max_distance;
+    n.param<double>("interpolation_max_distance", interpolation_max_distance, 2.0);
+
+    int count_of_queries, max_threads;
+    n.param<int>("queries", count_of_queries, 200);
+    n.param<int>("max_threads", max_threads, boost::thread::hardware_concurrency());
+
+    osm_planner::Parser map(file);
+    map.setTypeOfWays(types_of_ways);
+    map.setInterpolationMaxDistance(interpolation_max_distance);
+    map.parse();
+
+    int size = map.getGraphOfVertex()->size();
+    ROS_INFO("Benchmark: map %s, %d nodes, %d queries", file.c_str(), size, count_of_queries);
+
+    srand(0);
+    std::vector<QUERY> queries(count_of_queries);
+    for (int i = 0; i < count_of_queries; i++) {
+        queries[i].source = rand() % size;
+        queries[i].target = rand() % size;
+    }
+
+    double single_thread_rate = 0;
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+
+        osm_planner::WorkspacePool pool(threads);
+        boost::atomic<int> next(0);
+
+        boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+        boost::thread_group group;
+        for (int i = 0; i < threads; i++) {
+            group.create_thread(boost::bind(&worker, &map, &pool, &queries, &next));
+        }
+        group.join_all();
+
+        double time = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+        double rate = count_of_queries / time;
+        if (threads == 1)
+            single_thread_rate = rate;
+
+        ROS_INFO("Benchmark: threads %2d: %10.2f plans/s, speedup %5.2f", threads, rate, rate / single_thread_rate);
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/route_cache.h>
+
+namespace osm_planner {
+
+    RouteCache::RouteCache(int max_entries) : max_entries(max_entries), last_version(0), hits(0), misses(0) {
+    }
+
+    void RouteCache::setMaxEntries(int max_entries) {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+
+        this->max_entries = max_entries < 0 ? 0 : max_entries;
+        while (entries.size() > this->max_entries) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+    int RouteCache::getMaxEntries() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        return max_entries;
+    }
+
+    bool RouteCache::get(int sourceID, int targetID, unsigned long version, ROUTE *route) {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+
+        KEY key = {sourceID, targetID, version};
+        boost::unordered_map<KEY, ENTRIES::iterator, KeyHash>::iterator it = index.find(key);
+
+        if (it == index.end()) {
+            misses++;
+            return false;
+        }
+
+        //move entry to front of the list
+        entries.splice(entries.begin(), entries, it->second);
+        *route = it->second->second;
+        hits++;
+        return true;
+    }
+
+    void RouteCache::put(int sourceID, int targetID, unsigned long version, const ROUTE &route) {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+
+        if (max_entries == 0)
+            return;
+
+        //search finished late on older snapshot, its route can't be hit anymore
+        if (version < last_version)
+            return;
+
+        //routes from older graph can't be hit anymore
+        if (version > last_version) {
+            entries.clear();
+            index.clear();
+            last_version = version;
+        }
+
+        KEY key = {sourceID, targetID, version};
+        boost::unordered_map<KEY, ENTRIES::iterator, KeyHash>::iterator it = index.find(key);
+
+        if (it != index.end()) {
+            it->second->second = route;
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+
+        entries.push_front(std::make_pair(key, route));
+        index[key] = entries.begin();
+
+        if (entries.size() > max_entries) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+    void RouteCache::clear() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        entries.clear();
+        index.clear();
+    }
+
+    unsigned long RouteCache::getHits() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        return hits;
+    }
+
+    unsigned long RouteCache::getMisses() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        return misses;
+    }
+
+    int RouteCache::size() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        return entries.size();
+    }
+}
@@ -0,0 +1,204 @@
+/*
+ * search_benchmark.cpp
+ *
+ *  Created on: 18.10.2026
+ *      Author: michal
+ */
+
+#include <osm_planner/osm_parser.h>
+#include <osm_planner/graph_search.h>
+#include <osm_planner/next_hop_table.h>
+
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+
+//Comparison of search kernels - the same random plans are solved by Dijkstra on adjacency matrix,
+//binary heap on float adjacency lists, radix heap and bucket queue on centimetre adjacency lists.
+//All-pairs table is compared with the fastest search - memory, build time and count of queries, after which it pays off.
+//Fixed point node store is compared with vector of OSM_NODE - memory per node and time of nearest point scan.
+
+typedef struct query {
+    int source;
+    int target;
+} QUERY;
+
+typedef struct result {
+    double time;
+    double length;      //sum of lengths of found paths in metres, must be the same for all kernels
+    int found;
+} RESULT;
+
+double pathLength(std::vector<std::vector<float> > *graph, const std::vector<int> &nodes) {
+
+    double length = 0;
+    for (int i = 1; i < nodes.size(); i++) {
+        length += (*graph)[nodes[i - 1]][nodes[i]];
+    }
+    return length;
+}
+
+template<class Search, class Graph>
+RESULT benchmark(Search *search, const Graph &graph, std::vector<std::vector<float> > *matrix, const std::vector<QUERY> &queries) {
+
+    RESULT result = {0, 0, 0};
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+    for (int i = 0; i < queries.size(); i++) {
+        try {
+            std::vector<int> nodes = search->findShortestPath(graph, queries[i].source, queries[i].target);
+            result.length += pathLength(matrix, nodes);
+            result.found++;
+        } catch (osm_planner::dijkstra_exception &e) {
+            //unreachable target
+        }
+    }
+
+    result.time = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+//brute force snapping, like nearest point without grid, all nodes are read
+template<class Nodes>
+double nearestScan(const Nodes &nodes, const std::vector<osm_planner::Parser::OSM_NODE> &points, long *checksum) {
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+
+    for (int i = 0; i < points.size(); i++) {
+        int nearest = 0;
+        double min_distance = osm_planner::Parser::Haversine::getDistance(points[i], nodes[0]);
+        for (int j = 1; j < nodes.size(); j++) {
+            double distance = osm_planner::Parser::Haversine::getDistance(points[i], nodes[j]);
+            if (distance < min_distance) {
+                min_distance = distance;
+                nearest = j;
+            }
+        }
+        *checksum += nearest;
+    }
+    return boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+}
+
+void printResult(std::string name, RESULT result, RESULT reference, int count_of_queries) {
+
+    ROS_INFO("Benchmark: %-12s %10.2f plans/s, speedup %6.2f, found %d, total length %.2f m",
+             name.c_str(), count_of_queries / result.time, reference.time / result.time, result.found, result.length);
+}
+
+int main(int argc, char **argv) {
+
+    ros::init(argc, argv, "search_benchmark");
+    ros::NodeHandle n("~");
+
+    std::string file = "skuska.osm";
+    n.getParam("osm_map_path", file);
+
+    std::vector<std::string> types_of_ways;
+    n.getParam("filter_of_ways", types_of_ways);
+
+    double interpolation_max_distance;
+    n.param<double>("interpolation_max_distance", interpolation_max_distance, 2.0);
+
+    int count_of_queries;
+    n.param<int>("queries", count_of_queries, 200);
+
+    double memory_budget;
+    n.param<double>("memory_budget_mb", memory_budget, 256);
+
+    osm_planner::Parser map(file);
+    map.setTypeOfWays(types_of_ways);
+    map.setInterpolationMaxDistance(interpolation_max_distance);
+    map.parse();
+
+    std::vector<std::vector<float> > *matrix = map.getGraphOfVertex();
+    int size = matrix->size();
+
+    osm_planner::AdjacencyGraph<float> float_graph;
+    float_graph.build(matrix);
+
+    ROS_INFO("Benchmark: map %s, %d nodes, %d queries, max edge %u cm", file.c_str(), size, count_of_queries,
+             map.getIntegerGraph()->getMaxWeight());
+
+    srand(0);
+    std::vector<QUERY> queries(count_of_queries);
+    for (int i = 0; i < count_of_queries; i++) {
+        queries[i].source = rand() % size;
+        queries[i].target = rand() % size;
+    }
+
+    osm_planner::Dijkstra dijkstra;
+    RESULT matrix_result = benchmark(&dijkstra, matrix, matrix, queries);
+    printResult("matrix", matrix_result, matrix_result, count_of_queries);
+
+    osm_planner::HeapSearch heap_search;
+    RESULT heap_result = benchmark(&heap_search, float_graph, matrix, queries);
+    printResult("binary_heap", heap_result, matrix_result, count_of_queries);
+
+    osm_planner::RadixHeapSearch radix_search;
+    RESULT radix_result = benchmark(&radix_search, *map.getIntegerGraph(), matrix, queries);
+    printResult("radix_heap", radix_result, matrix_result, count_of_queries);
+
+    osm_planner::BucketSearch bucket_search;
+    RESULT bucket_result = benchmark(&bucket_search, *map.getIntegerGraph(), matrix, queries);
+    printResult("bucket", bucket_result, matrix_result, count_of_queries);
+
+    //all-pairs next hop table
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    osm_planner::NextHopTable table;
+    table.build(*map.getIntegerGraph(), map.getGraphVersion(), boost::thread::hardware_concurrency());
+    double build_time = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+    RESULT table_result = {0, 0, 0};
+    start = boost::chrono::steady_clock::now();
+    for (int i = 0; i < queries.size(); i++) {
+        std::vector<int> nodes = table.getPath(queries[i].source, queries[i].target);
+        if (!nodes.empty()) {
+            table_result.length += pathLength(matrix, nodes);
+            table_result.found++;
+        }
+    }
+    table_result.time = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+    printResult("all_pairs", table_result, matrix_result, count_of_queries);
+
+    //crossover - table is built once, every query saves difference of latencies
+    double search_latency = std::min(radix_result.time, bucket_result.time) / count_of_queries;
+    double table_latency = table_result.time / count_of_queries;
+    double memory = table.getMemory() / (1024.0 * 1024.0);
+
+    ROS_INFO("Benchmark: all-pairs table %.2f MB, build %.3f s, latency %.6f ms (search %.6f ms)",
+             memory, build_time, table_latency * 1000, search_latency * 1000);
+
+    if (search_latency > table_latency)
+        ROS_INFO("Benchmark: all-pairs table pays off after %.0f queries", build_time / (search_latency - table_latency));
+    else
+        ROS_INFO("Benchmark: all-pairs table never pays off on this map");
+
+    //memory grows with N^2, so the budget gives the biggest map for the table
+    ROS_INFO("Benchmark: memory budget %.0f MB fits all-pairs table up to %.0f nodes (this map %d nodes)",
+             memory_budget, sqrt(memory_budget * 1024 * 1024 / 8), size);
+
+    //node storage
+    std::vector<osm_planner::Parser::OSM_NODE> plain_nodes;
+    osm_planner::NodeStore<osm_planner::Parser::OSM_NODE> compact_nodes;
+    compact_nodes.resize(size);
+    for (int i = 0; i < size; i++) {
+        plain_nodes.push_back(map.getNodeByID(i));
+        compact_nodes.set(i, plain_nodes.back());
+    }
+
+    std::vector<osm_planner::Parser::OSM_NODE> points;
+    for (int i = 0; i < queries.size() && i < 50; i++) {
+        points.push_back(plain_nodes[queries[i].source]);
+        points.back().latitude += 0.00005;
+    }
+
+    long plain_checksum = 0, compact_checksum = 0;
+    double plain_time = nearestScan(plain_nodes, points, &plain_checksum);
+    double compact_time = nearestScan(compact_nodes, points, &compact_checksum);
+
+    ROS_INFO("Benchmark: nodes %d B/node fixed point, %d B/node OSM_NODE, nearest scan %.3f ms / %.3f ms (%.2fx), %s",
+             (int) (compact_nodes.getMemory() / std::max(size, 1)), (int) sizeof(osm_planner::Parser::OSM_NODE),
+             compact_time * 1000 / std::max((int) points.size(), 1), plain_time * 1000 / std::max((int) points.size(), 1),
+             compact_time / plain_time, plain_checksum == compact_checksum ? "same results" : "different results");
+
+    return 0;
+}
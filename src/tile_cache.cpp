@@ -0,0 +1,355 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/tile_cache.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace osm_planner {
+
+    const std::string TileCache::INDEX_FILE = "tiles.index";
+
+    TileCache::TileCache(Parser *map) : map(map), tile_size(0), max_tiles(0), prefetch_radius(0), opened(false),
+                                        sync_loads(0), sync_load_time(0), max_sync_load_time(0),
+                                        running(false), new_position(false), has_position(false), position(0, 0) {
+    }
+
+    TileCache::~TileCache() {
+
+        {
+            boost::mutex::scoped_lock lock(prefetch_mutex);
+            running = false;
+            prefetch_wakeup.notify_all();
+        }
+
+        if (prefetch_thread)
+            prefetch_thread->join();
+    }
+
+    //index contains size of tile [deg] and rows and columns of all tiles
+    bool TileCache::open(std::string directory, int max_tiles, int prefetch_radius) {
+
+        std::ifstream index((directory + "/" + INDEX_FILE).c_str());
+        if (!index || !(index >> tile_size) || tile_size <= 0) {
+            ROS_ERROR("OSM planner: Can't read index of tiles in %s", directory.c_str());
+            return false;
+        }
+
+        int row, col;
+        while (index >> row >> col) {
+            available.insert(TILE_ID(row, col));
+        }
+
+        this->directory = directory;
+        this->max_tiles = std::max(max_tiles, 1);
+        this->prefetch_radius = std::max(prefetch_radius, 0);
+        opened = true;
+
+        running = true;
+        prefetch_thread = boost::shared_ptr<boost::thread>(new boost::thread(&TileCache::prefetchThread, this));
+
+        ROS_INFO("OSM planner: Opened compiled map %s, %d tiles of %f deg", directory.c_str(), (int) available.size(), tile_size);
+        return true;
+    }
+
+    bool TileCache::isOpen() {
+
+        return opened;
+    }
+
+    void TileCache::setPosition(double latitude, double longitude, bool wait) {
+
+        TILE_ID tile = getTile(latitude, longitude);
+
+        {
+            boost::mutex::scoped_lock lock(prefetch_mutex);
+
+            //robot is still in the same tile
+            if (!wait && has_position && position == tile)
+                return;
+            position = tile;
+            has_position = true;
+        }
+
+        boost::unordered_set<TILE_ID> tiles;
+        getTilesAround(tile, prefetch_radius, &tiles);
+
+        {
+            boost::mutex::scoped_lock lock(cache_mutex);
+            position_tiles = tiles;
+        }
+
+        if (wait) {
+            loadSync(tiles);
+            return;
+        }
+
+        boost::mutex::scoped_lock lock(prefetch_mutex);
+        new_position = true;
+        prefetch_wakeup.notify_all();
+    }
+
+    int TileCache::loadCorridor(const std::vector<Parser::OSM_NODE> &points, int radius) {
+
+        //segments are sampled by quarters of tile, so no crossed tile is skipped
+        boost::unordered_set<TILE_ID> route;
+        for (int i = 0; i < points.size(); i++) {
+
+            route.insert(getTile(points[i].latitude, points[i].longitude));
+            if (i == 0)
+                continue;
+
+            double dLat = points[i].latitude - points[i - 1].latitude;
+            double dLon = points[i].longitude - points[i - 1].longitude;
+            int steps = (int) ceil(std::max(fabs(dLat), fabs(dLon)) / (tile_size / 4));
+
+            for (int s = 1; s < steps; s++) {
+                double t = (double) s / steps;
+                route.insert(getTile(points[i - 1].latitude + t * dLat, points[i - 1].longitude + t * dLon));
+            }
+        }
+
+        boost::unordered_set<TILE_ID> corridor;
+        for (boost::unordered_set<TILE_ID>::iterator it = route.begin(); it != route.end(); it++) {
+            getTilesAround(*it, radius, &corridor);
+        }
+
+        {
+            boost::mutex::scoped_lock lock(cache_mutex);
+            corridor_tiles = corridor;
+        }
+
+        return loadSync(corridor);
+    }
+
+    int TileCache::loadAround(double latitude, double longitude, double distance) {
+
+        //the smaller side of tile
+        Parser::OSM_NODE point = {latitude, longitude, 0, 0};
+        Parser::OSM_NODE east = {latitude, longitude + tile_size, 0, 0};
+        Parser::OSM_NODE north = {latitude + tile_size, longitude, 0, 0};
+        double tile_metres = std::min(Parser::Haversine::getDistance(point, east), Parser::Haversine::getDistance(point, north));
+
+        boost::unordered_set<TILE_ID> tiles;
+        getTilesAround(getTile(latitude, longitude), (int) ceil(distance / tile_metres), &tiles);
+        return loadSync(tiles);
+    }
+
+    Parser::OSM_NODE TileCache::getFirstTileCenter() {
+
+        Parser::OSM_NODE center = {0, 0, 0, 0};
+        if (available.empty())
+            return center;
+
+        TILE_ID tile = *available.begin();
+        center.latitude = (tile.first + 0.5) * tile_size;
+        center.longitude = (tile.second + 0.5) * tile_size;
+        return center;
+    }
+
+    int TileCache::getSyncLoads() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        return sync_loads;
+    }
+
+    double TileCache::getSyncLoadTime() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        return sync_load_time;
+    }
+
+    double TileCache::getMaxSyncLoadTime() {
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+        return max_sync_load_time;
+    }
+
+    std::string TileCache::getTileFile(std::string directory, TILE_ID tile) {
+
+        std::stringstream file;
+        file << directory << "/" << tile.first << "_" << tile.second << ".osm";
+        return file.str();
+    }
+
+    /*--------------------PRIVATE FUNCTIONS---------------------*/
+
+    TileCache::TILE_ID TileCache::getTile(double latitude, double longitude) {
+
+        return TILE_ID((int) floor(latitude / tile_size), (int) floor(longitude / tile_size));
+    }
+
+    void TileCache::getTilesAround(TILE_ID center, int radius, boost::unordered_set<TILE_ID> *tiles) {
+
+        for (int row = center.first - radius; row <= center.first + radius; row++) {
+            for (int col = center.second - radius; col <= center.second + radius; col++) {
+                tiles->insert(TILE_ID(row, col));
+            }
+        }
+    }
+
+    int TileCache::load(const boost::unordered_set<TILE_ID> &tiles) {
+
+        int count = 0;
+        for (boost::unordered_set<TILE_ID>::const_iterator it = tiles.begin(); it != tiles.end(); it++) {
+            if (load(*it))
+                count++;
+        }
+        return count;
+    }
+
+    //routing waits for these tiles, so the latency is measured
+    int TileCache::loadSync(const boost::unordered_set<TILE_ID> &tiles) {
+
+        ros::WallTime start_time = ros::WallTime::now();
+        int count = load(tiles);
+        double time = (ros::WallTime::now() - start_time).toSec();
+
+        if (count > 0) {
+            boost::mutex::scoped_lock lock(cache_mutex);
+            sync_loads++;
+            sync_load_time += time;
+            max_sync_load_time = std::max(max_sync_load_time, time);
+            ROS_INFO("OSM planner: Loaded %d tiles synchronously, latency: %f ms (max %f ms)", count, time * 1000, max_sync_load_time * 1000);
+        }
+        return count;
+    }
+
+    //file is read without lock, so loading of other tiles and planning aren't blocked
+    bool TileCache::load(TILE_ID tile) {
+
+        if (!available.count(tile))
+            return false;
+
+        {
+            boost::mutex::scoped_lock lock(cache_mutex);
+            boost::unordered_map<TILE_ID, LOADED_TILE>::iterator it = loaded.find(tile);
+            if (it != loaded.end()) {
+                lru.splice(lru.begin(), lru, it->second.lru);
+                return false;
+            }
+        }
+
+        std::vector<Parser::OSM_WAY> ways;
+        boost::unordered_map<int, Parser::OSM_NODE> nodes;
+        if (!readTile(getTileFile(directory, tile), &ways, &nodes)) {
+            ROS_WARN("OSM planner: Can't read tile %s", getTileFile(directory, tile).c_str());
+            return false;
+        }
+
+        boost::mutex::scoped_lock lock(cache_mutex);
+
+        //other thread was faster
+        if (loaded.count(tile))
+            return false;
+
+        LOADED_TILE entry;
+        std::vector<Parser::OSM_WAY> new_ways;
+        for (int i = 0; i < ways.size(); i++) {
+            entry.ways.push_back(ways[i].id);
+            if (way_users[ways[i].id]++ == 0)
+                new_ways.push_back(ways[i]);
+        }
+        map->addWays(new_ways, nodes);
+
+        lru.push_front(tile);
+        entry.lru = lru.begin();
+        loaded[tile] = entry;
+
+        evict();
+        return true;
+    }
+
+    //the least recently used tiles, which aren't around the robot or on the corridor, cache_mutex must be held
+    void TileCache::evict() {
+
+        std::vector<int> removed;
+        std::list<TILE_ID>::iterator it = lru.end();
+
+        while (loaded.size() > max_tiles && it != lru.begin()) {
+
+            it--;
+            TILE_ID tile = *it;
+            if (position_tiles.count(tile) || corridor_tiles.count(tile))
+                continue;
+
+            const std::vector<int> &ways = loaded[tile].ways;
+            for (int i = 0; i < ways.size(); i++) {
+                if (--way_users[ways[i]] == 0) {
+                    way_users.erase(ways[i]);
+                    removed.push_back(ways[i]);
+                }
+            }
+
+            loaded.erase(tile);
+            it = lru.erase(it);
+        }
+
+        if (!removed.empty())
+            map->removeWays(removed);
+    }
+
+    //tile is OSM file with nodes and ways, which were already filtered by map_tiler
+    bool TileCache::readTile(std::string file, std::vector<Parser::OSM_WAY> *ways, boost::unordered_map<int, Parser::OSM_NODE> *nodes) {
+
+        TiXmlDocument doc(file);
+        if (!doc.LoadFile())
+            return false;
+
+        TiXmlElement *root = doc.FirstChildElement("osm");
+        if (!root)
+            return false;
+
+        for (TiXmlElement *element = root->FirstChildElement("node"); element; element = element->NextSiblingElement("node")) {
+
+            int id;
+            Parser::OSM_NODE node = {0, 0, 0, 0};
+            element->Attribute("id", &id);
+            element->Attribute("lat", &node.latitude);
+            element->Attribute("lon", &node.longitude);
+            (*nodes)[id] = node;
+        }
+
+        for (TiXmlElement *element = root->FirstChildElement("way"); element; element = element->NextSiblingElement("way")) {
+
+            Parser::OSM_WAY way;
+            element->Attribute("id", &way.id);
+
+            for (TiXmlElement *nd = element->FirstChildElement("nd"); nd; nd = nd->NextSiblingElement("nd")) {
+                int ref;
+                nd->Attribute("ref", &ref);
+                way.refs.push_back(ref);
+            }
+            ways->push_back(way);
+        }
+        return true;
+    }
+
+    //background loading of tiles around the robot, it waits for new tile of position
+    void TileCache::prefetchThread() {
+
+        while (true) {
+
+            TILE_ID tile;
+            {
+                boost::mutex::scoped_lock lock(prefetch_mutex);
+                while (running && !new_position) {
+                    prefetch_wakeup.wait(lock);
+                }
+                if (!running)
+                    return;
+
+                tile = position;
+                new_position = false;
+            }
+
+            boost::unordered_set<TILE_ID> tiles;
+            getTilesAround(tile, prefetch_radius, &tiles);
+
+            int count = load(tiles);
+            if (count > 0)
+                ROS_INFO("OSM planner: Prefetched %d tiles around tile [%d, %d]", count, tile.first, tile.second);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/workspace_pool.h>
+
+namespace osm_planner {
+
+    WorkspacePool::WorkspacePool(int size) {
+
+        resize(size);
+    }
+
+    //must not be called while some workspace is borrowed
+    void WorkspacePool::resize(int size) {
+
+        boost::mutex::scoped_lock lock(pool_mutex);
+
+        if (size < 1)
+            size = 1;
+
+        workspaces.clear();
+        free_workspaces.clear();
+
+        for (int i = 0; i < size; i++) {
+            workspaces.push_back(boost::shared_ptr<SEARCH_WORKSPACE>(new SEARCH_WORKSPACE()));
+            free_workspaces.push_back(workspaces.back().get());
+        }
+    }
+
+    int WorkspacePool::size() {
+
+        boost::mutex::scoped_lock lock(pool_mutex);
+        return workspaces.size();
+    }
+
+    SEARCH_WORKSPACE *WorkspacePool::acquire() {
+
+        boost::mutex::scoped_lock lock(pool_mutex);
+
+        while (free_workspaces.empty()) {
+            workspace_released.wait(lock);
+        }
+
+        SEARCH_WORKSPACE *workspace = free_workspaces.back();
+        free_workspaces.pop_back();
+        return workspace;
+    }
+
+    void WorkspacePool::release(SEARCH_WORKSPACE *workspace) {
+
+        {
+            boost::mutex::scoped_lock lock(pool_mutex);
+            free_workspaces.push_back(workspace);
+        }
+        workspace_released.notify_one();
+    }
+}
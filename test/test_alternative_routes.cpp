@@ -0,0 +1,155 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/alternative_routes.h>
+#include "test_graphs.h"
+
+#include <gtest/gtest.h>
+#include <set>
+
+using namespace osm_planner;
+
+static unsigned int getLength(const IntegerGraph &graph, const std::vector<int> &route) {
+
+    unsigned int length = 0;
+    for (int i = 1; i < route.size(); i++) {
+        length += graph.getWeight(route[i - 1], route[i]);
+    }
+    return length;
+}
+
+//length of undirected edges of route, which are in the other route too
+static unsigned int getSharedLength(const IntegerGraph &graph, const std::vector<int> &route, const std::vector<int> &other) {
+
+    std::set<std::pair<int, int> > edges;
+    for (int i = 1; i < other.size(); i++) {
+        edges.insert(std::make_pair(std::min(other[i - 1], other[i]), std::max(other[i - 1], other[i])));
+    }
+
+    unsigned int shared = 0;
+    for (int i = 1; i < route.size(); i++) {
+        if (edges.count(std::make_pair(std::min(route[i - 1], route[i]), std::max(route[i - 1], route[i]))))
+            shared += graph.getWeight(route[i - 1], route[i]);
+    }
+    return shared;
+}
+
+//every route is simple path in the graph, the first one is the shortest,
+//others are within the stretch and share limits against all routes before them
+static void expectValidRoutes(const IntegerGraph &graph, const std::vector<std::vector<int> > &routes, int src, int target,
+                              int max_routes, double max_stretch, double max_share) {
+
+    RadixHeapSearch search;
+    search.findDistances(graph, src);
+    unsigned int shortest = search.getDistance(target);
+
+    ASSERT_FALSE(routes.empty());
+    EXPECT_LE((int) routes.size(), max_routes + 1);
+    EXPECT_EQ(shortest, getLength(graph, routes[0]));
+
+    for (int i = 0; i < routes.size(); i++) {
+
+        const std::vector<int> &route = routes[i];
+        EXPECT_EQ(src, route.front());
+        EXPECT_EQ(target, route.back());
+
+        std::set<int> nodes(route.begin(), route.end());
+        EXPECT_EQ(route.size(), nodes.size()) << "route " << i << " isn't simple";
+
+        for (int j = 1; j < route.size(); j++) {
+            EXPECT_NE(IntegerGraph::INFINITY_WEIGHT, graph.getWeight(route[j - 1], route[j])) << "route " << i << " uses missing edge";
+        }
+
+        unsigned int length = getLength(graph, route);
+        EXPECT_LE(length, max_stretch * shortest + 1e-6) << "route " << i;
+
+        for (int j = 0; j < i; j++) {
+            EXPECT_LE(getSharedLength(graph, route, routes[j]), max_share * length + 1e-6) << "routes " << i << ", " << j;
+        }
+    }
+}
+
+TEST(AlternativeRoutes, RoutesKeepStretchAndShare) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(20, 20, 1);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    AlternativeRoutes alternatives(3, 1.4, 0.7);
+    int found = 0;
+
+    for (int src = 0; src < 400; src += 37) {
+        for (int target = 399; target > 0; target -= 53) {
+
+            RadixHeapSearch search;
+            search.findDistances(graph, src);
+            if (src == target || search.getDistance(target) == IntegerGraph::INFINITY_WEIGHT)
+                continue;
+
+            std::vector<std::vector<int> > routes = alternatives.findRoutes(graph, src, target);
+            expectValidRoutes(graph, routes, src, target, 3, 1.4, 0.7);
+            found += routes.size() - 1;
+        }
+    }
+
+    //random grid has detours within the limits
+    EXPECT_GT(found, 0);
+}
+
+TEST(AlternativeRoutes, TightLimits) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(15, 15, 2);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    AlternativeRoutes alternatives(5, 1.1, 0.3);
+    for (int target = 1; target < 225; target += 17) {
+
+        RadixHeapSearch search;
+        search.findDistances(graph, 0);
+        if (search.getDistance(target) == IntegerGraph::INFINITY_WEIGHT)
+            continue;
+
+        expectValidRoutes(graph, alternatives.findRoutes(graph, 0, target), 0, target, 5, 1.1, 0.3);
+    }
+}
+
+//two parallel paths share no edge, the longer one has plateau 3 - 4
+TEST(AlternativeRoutes, ParallelPaths) {
+
+    std::vector<std::vector<float> > matrix(6, std::vector<float>(6, 0));
+    matrix[0][1] = matrix[1][0] = 10;
+    matrix[1][2] = matrix[2][1] = 10;
+    matrix[2][5] = matrix[5][2] = 10;
+    matrix[0][3] = matrix[3][0] = 11;
+    matrix[3][4] = matrix[4][3] = 11;
+    matrix[4][5] = matrix[5][4] = 11;
+
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    std::vector<std::vector<int> > routes = AlternativeRoutes(2, 1.4, 0.7).findRoutes(graph, 0, 5);
+    ASSERT_EQ(2u, routes.size());
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 5}), routes[0]);
+    EXPECT_EQ(std::vector<int>({0, 3, 4, 5}), routes[1]);
+
+    //3300 cm is over 1.05 * 3000 cm
+    EXPECT_EQ(1u, AlternativeRoutes(2, 1.05, 0.7).findRoutes(graph, 0, 5).size());
+}
+
+TEST(AlternativeRoutes, UnreachableTarget) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(5, 5, 3);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    //the last node is isolated
+    AlternativeRoutes alternatives;
+    EXPECT_THROW(alternatives.findRoutes(graph, 0, graph.size() - 1), dijkstra_exception);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
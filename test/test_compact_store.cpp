@@ -0,0 +1,153 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/compact_store.h>
+
+#include <gtest/gtest.h>
+#include <climits>
+#include <random>
+
+using namespace osm_planner;
+
+typedef struct node {
+    double latitude;
+    double longitude;
+    double altitude;
+} NODE;
+
+TEST(VarintArena, RoundTrip) {
+
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> length(0, 50);
+    std::uniform_int_distribution<int> step(-1000, 1000);
+    std::uniform_int_distribution<int> any(INT_MIN, INT_MAX);
+
+    VarintArena arena;
+    std::vector<std::vector<int> > lists;
+
+    //osm IDs of way - close values, random values and extremes
+    for (int i = 0; i < 200; i++) {
+        std::vector<int> list(length(generator));
+        int value = any(generator) / 2;
+        for (int j = 0; j < list.size(); j++) {
+            value += step(generator);
+            list[j] = i % 3 ? value : any(generator);
+        }
+        lists.push_back(list);
+    }
+    int extremes[] = {INT_MIN, INT_MAX, 0, INT_MIN, -1, INT_MAX, INT_MAX, 1};
+    lists.push_back(std::vector<int>(extremes, extremes + 8));
+
+    for (int i = 0; i < lists.size(); i++) {
+        EXPECT_EQ(i, arena.append(lists[i]));
+    }
+    EXPECT_EQ(lists.size(), arena.size());
+
+    std::vector<int> list;
+    for (int i = lists.size() - 1; i >= 0; i--) {
+        arena.get(i, &list);
+        EXPECT_EQ(lists[i], list) << "list " << i;
+    }
+
+    arena.clear();
+    EXPECT_EQ(0, arena.size());
+}
+
+TEST(VarintArena, NearbyValuesAreShort) {
+
+    VarintArena arena;
+    std::vector<int> list;
+    for (int i = 0; i < 1000; i++) {
+        list.push_back(300000000 + i * 3);
+    }
+    arena.append(list);
+
+    //the first value has 5 bytes, differences 1 byte, count 2 bytes
+    EXPECT_LE(arena.getMemory(), 2 * (1000 + 16) + sizeof(unsigned int) * 4);
+}
+
+TEST(NodeStore, RoundTrip) {
+
+    std::mt19937 generator(2);
+    std::uniform_real_distribution<double> latitude(-90, 90);
+    std::uniform_real_distribution<double> longitude(-180, 180);
+
+    NodeStore<NODE> store;
+    std::vector<NODE> nodes;
+    for (int i = 0; i < 1000; i++) {
+        NODE n = {latitude(generator), longitude(generator), 5};
+        nodes.push_back(n);
+        store.push_back(n);
+    }
+
+    ASSERT_EQ(nodes.size(), store.size());
+    for (int i = 0; i < nodes.size(); i++) {
+
+        //fixed point 1e-7 deg, other fields are 0
+        EXPECT_NEAR(nodes[i].latitude, store[i].latitude, 0.5e-7);
+        EXPECT_NEAR(nodes[i].longitude, store[i].longitude, 0.5e-7);
+        EXPECT_EQ(0, store[i].altitude);
+        EXPECT_EQ(store[i].latitude, store.getLatitude(i));
+        EXPECT_EQ(store[i].longitude, store.getLongitude(i));
+    }
+
+    NODE changed = {48.1234567, 17.1234567, 0};
+    store.set(10, changed);
+    EXPECT_NEAR(changed.latitude, store[10].latitude, 0.5e-7);
+    EXPECT_NEAR(changed.longitude, store[10].longitude, 0.5e-7);
+
+    store.resize(1200);
+    EXPECT_EQ(1200, store.size());
+    EXPECT_EQ(0, store[1100].latitude);
+    EXPECT_NEAR(nodes[999].latitude, store[999].latitude, 0.5e-7);
+}
+
+TEST(NodeStore, AttachedArraysAreCopiedBeforeChange) {
+
+    int latitudes[] = {481000000, 482000000, 483000000};
+    int longitudes[] = {171000000, 172000000, 173000000};
+
+    NodeStore<NODE> store;
+    store.attach(3, latitudes, longitudes);
+    EXPECT_TRUE(store.isAttached());
+    EXPECT_EQ(0u, store.getMemory());
+    EXPECT_DOUBLE_EQ(48.2, store[1].latitude);
+
+    //copy reads the same arrays
+    NodeStore<NODE> copy = store;
+    EXPECT_TRUE(copy.isAttached());
+    EXPECT_DOUBLE_EQ(17.3, copy[2].longitude);
+
+    NODE n = {49, 18, 0};
+    store.set(1, n);
+    EXPECT_FALSE(store.isAttached());
+    EXPECT_DOUBLE_EQ(49, store[1].latitude);
+    EXPECT_DOUBLE_EQ(48.1, store[0].latitude);
+    EXPECT_EQ(482000000, latitudes[1]);
+    EXPECT_DOUBLE_EQ(48.2, copy[1].latitude);
+}
+
+TEST(NodeStore, SwapKeepsNodes) {
+
+    NodeStore<NODE> a, b;
+    NODE n1 = {1, 2, 0}, n2 = {3, 4, 0};
+    a.push_back(n1);
+    b.push_back(n2);
+    b.push_back(n1);
+
+    a.swap(b);
+    ASSERT_EQ(2, a.size());
+    ASSERT_EQ(1, b.size());
+    EXPECT_DOUBLE_EQ(3, a[0].latitude);
+    EXPECT_DOUBLE_EQ(2, a[1].longitude);
+    EXPECT_DOUBLE_EQ(1, b[0].latitude);
+
+    b.clear();
+    EXPECT_TRUE(b.empty());
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
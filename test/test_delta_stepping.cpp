@@ -0,0 +1,83 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/delta_stepping.h>
+#include "test_graphs.h"
+
+#include <gtest/gtest.h>
+
+using namespace osm_planner;
+
+//distances are compared with the radix heap search, which is tested against the matrix Dijkstra,
+//parents must form shortest path tree
+static void expectSameDistances(const IntegerGraph &graph, DeltaStepping *search, int src, unsigned int max_distance) {
+
+    RadixHeapSearch reference;
+    reference.findDistances(graph, src);
+    search->findDistances(graph, src, max_distance);
+
+    const std::vector<unsigned int> &distance = search->getDistances();
+    const std::vector<int> &parent = search->getParents();
+    ASSERT_EQ(graph.size(), distance.size());
+
+    for (int v = 0; v < graph.size(); v++) {
+
+        unsigned int expected = reference.getDistance(v);
+        if (expected > max_distance)
+            expected = IntegerGraph::INFINITY_WEIGHT;
+        EXPECT_EQ(expected, distance[v]) << src << " -> " << v;
+
+        if (v != src && distance[v] != IntegerGraph::INFINITY_WEIGHT) {
+            ASSERT_NE(-1, parent[v]);
+            EXPECT_EQ(distance[v], distance[parent[v]] + graph.getWeight(parent[v], v)) << src << " -> " << v;
+        }
+    }
+}
+
+TEST(DeltaStepping, OneThreadMatchesDijkstra) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(15, 15, 1);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    DeltaStepping search(1, 2000);
+    for (int src = 0; src < graph.size(); src += 11) {
+        expectSameDistances(graph, &search, src, IntegerGraph::INFINITY_WEIGHT);
+    }
+}
+
+//big buckets give frontiers, which are relaxed by all threads
+TEST(DeltaStepping, ThreadsMatchDijkstra) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(50, 50, 2);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    unsigned int deltas[] = {500, 5000, 50000};
+    for (int i = 0; i < 3; i++) {
+        DeltaStepping search(4, deltas[i]);
+        for (int src = 0; src < graph.size(); src += 499) {
+            expectSameDistances(graph, &search, src, IntegerGraph::INFINITY_WEIGHT);
+        }
+    }
+}
+
+TEST(DeltaStepping, NodesOverMaxDistanceAreUnreached) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(30, 30, 3);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    DeltaStepping search(4, 3000);
+    expectSameDistances(graph, &search, 0, 50000);
+    expectSameDistances(graph, &search, 465, 120000);
+
+    //the search object is reused with the whole graph
+    expectSameDistances(graph, &search, 465, IntegerGraph::INFINITY_WEIGHT);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,215 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/distance_field.h>
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace osm_planner;
+
+//rows and every second column of perturbed grid are ways, one way is diagonal,
+//attached shared graph has only edges, so ways can be left out
+static void createGraph(Parser::GRAPH *graph, bool with_ways) {
+
+    const int K = 10;
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> noise(-1e-4, 1e-4);
+
+    for (int i = 0; i < K; i++) {
+        for (int j = 0; j < K; j++) {
+            Parser::OSM_NODE node = Parser::OSM_NODE();
+            node.latitude = 48 + 0.0005 * i + noise(generator);
+            node.longitude = 17 + 0.0007 * j + noise(generator);
+            graph->nodes.push_back(node);
+            graph->integer_graph.addNode();
+        }
+    }
+
+    std::vector<std::vector<int> > ways;
+    for (int i = 0; i < K; i++) {
+        std::vector<int> row;
+        for (int j = 0; j < K; j++) {
+            row.push_back(i * K + j);
+        }
+        ways.push_back(row);
+    }
+    for (int j = 0; j < K; j += 2) {
+        std::vector<int> column;
+        for (int i = 0; i < K; i++) {
+            column.push_back(i * K + j);
+        }
+        ways.push_back(column);
+    }
+    std::vector<int> diagonal;
+    diagonal.push_back(0);
+    diagonal.push_back(K * K - 1);
+    ways.push_back(diagonal);
+
+    for (int w = 0; w < ways.size(); w++) {
+
+        Parser::OSM_WAY way;
+        way.id = w;
+        way.nodesId = ways[w];
+        if (with_ways)
+            graph->ways.push_back(way);
+
+        for (int i = 1; i < way.nodesId.size(); i++) {
+            int u = way.nodesId[i - 1], v = way.nodesId[i];
+            double length = Parser::Haversine::getDistance(graph->nodes[u], graph->nodes[v]) * INTEGER_GRAPH_SCALE;
+            graph->integer_graph.setEdge(u, v, length);
+            graph->integer_graph.setEdge(v, u, length);
+        }
+    }
+}
+
+static double getSegmentDistance(double x, double y, double ax, double ay, double bx, double by) {
+
+    double dx = bx - ax, dy = by - ay;
+    double length2 = dx * dx + dy * dy;
+    double t = length2 > 0 ? std::max(0.0, std::min(1.0, ((x - ax) * dx + (y - ay) * dy) / length2)) : 0;
+    return hypot(ax + t * dx - x, ay + t * dy - y);
+}
+
+class DistanceFieldTest : public testing::Test {
+protected:
+
+    Parser::GRAPH graph;
+    Parser::Haversine calculator;
+    std::vector<double> xs, ys;
+
+    void SetUp() {
+
+        createGraph(&graph, true);
+        calculator.setOrigin(48.002, 17.003);
+        for (int i = 0; i < graph.nodes.size(); i++) {
+            xs.push_back(calculator.getCoordinateX(graph.nodes[i]));
+            ys.push_back(calculator.getCoordinateY(graph.nodes[i]));
+        }
+    }
+
+    //brute force over all edges
+    double getDistance(double x, double y) {
+
+        double best = std::numeric_limits<double>::infinity();
+        const IntegerGraph &g = graph.integer_graph;
+        for (int u = 0; u < g.size(); u++) {
+            for (int e = g.begin(u); e < g.end(u); e++) {
+                int v = g.target(e);
+                best = std::min(best, getSegmentDistance(x, y, xs[u], ys[u], xs[v], ys[v]));
+            }
+        }
+        return best;
+    }
+
+    //distance of every cell is exact distance of its centre, so the error is at most half of cell diagonal
+    void expectDistances(const DistanceField &field, double margin, int points) {
+
+        double bound = field.getResolution() * sqrt(2.0) / 2 + 1e-3;
+        double min_x = *std::min_element(xs.begin(), xs.end()), max_x = *std::max_element(xs.begin(), xs.end());
+        double min_y = *std::min_element(ys.begin(), ys.end()), max_y = *std::max_element(ys.begin(), ys.end());
+
+        std::mt19937 generator(1);
+        std::uniform_real_distribution<double> random_x(min_x - margin, max_x + margin);
+        std::uniform_real_distribution<double> random_y(min_y - margin, max_y + margin);
+
+        for (int i = 0; i < points; i++) {
+
+            double x = random_x(generator), y = random_y(generator);
+            double expected = getDistance(x, y);
+
+            EXPECT_NEAR(expected, field.getDistance(x, y), bound) << x << ", " << y;
+
+            //the nearest edge is edge of way, which is at most cell diagonal farther than the nearest one
+            DistanceField::EDGE edge;
+            ASSERT_TRUE(field.getNearestEdge(x, y, &edge));
+            EXPECT_NE(IntegerGraph::INFINITY_WEIGHT, graph.integer_graph.getWeight(edge.source, edge.target));
+            EXPECT_LE(getSegmentDistance(x, y, xs[edge.source], ys[edge.source], xs[edge.target], ys[edge.target]),
+                      expected + 2 * bound);
+        }
+    }
+};
+
+TEST_F(DistanceFieldTest, DistancesMatchSegments) {
+
+    double resolutions[] = {0.5, 1.0, 2.0};
+    for (int i = 0; i < 3; i++) {
+
+        DistanceField field;
+        field.build(&graph, &calculator, resolutions[i], 20, 0);
+        EXPECT_DOUBLE_EQ(resolutions[i], field.getResolution());
+        expectDistances(field, 20, 2000);
+    }
+}
+
+TEST_F(DistanceFieldTest, OutOfRaster) {
+
+    DistanceField field;
+    field.build(&graph, &calculator, 1.0, 10, 0);
+
+    double x = *std::max_element(xs.begin(), xs.end()) + 50;
+    DistanceField::EDGE edge;
+    EXPECT_LT(field.getDistance(x, ys[0]), 0);
+    EXPECT_FALSE(field.getNearestEdge(x, ys[0], &edge));
+
+    //empty graph has no raster
+    Parser::GRAPH empty;
+    DistanceField empty_field;
+    empty_field.build(&empty, &calculator, 1.0, 10, 0);
+    EXPECT_LT(empty_field.getDistance(xs[0], ys[0]), 0);
+    EXPECT_FALSE(empty_field.getNearestEdge(xs[0], ys[0], &edge));
+}
+
+//refused edges are still on the way, so the off-way distance isn't changed by them
+TEST_F(DistanceFieldTest, DeletedEdgesDontChangeField) {
+
+    DistanceField field;
+    field.build(&graph, &calculator, 1.0, 10, 0);
+
+    //the first row
+    for (int u = 0; u < 9; u++) {
+        graph.integer_graph.deleteEdge(u, u + 1);
+        graph.integer_graph.deleteEdge(u + 1, u);
+    }
+
+    DistanceField rebuilt;
+    rebuilt.build(&graph, &calculator, 1.0, 10, 0);
+
+    for (int i = 0; i < xs.size(); i++) {
+        EXPECT_EQ(field.getDistance(xs[i] + 3, ys[i] - 2), rebuilt.getDistance(xs[i] + 3, ys[i] - 2));
+    }
+
+    //points on deleted edges are on the way
+    for (int u = 0; u < 9; u++) {
+        for (double t = 0.1; t < 1; t += 0.2) {
+            double x = xs[u] + t * (xs[u + 1] - xs[u]), y = ys[u] + t * (ys[u + 1] - ys[u]);
+            EXPECT_LT(rebuilt.getDistance(x, y), sqrt(2.0) / 2 + 1e-3);
+        }
+    }
+}
+
+TEST_F(DistanceFieldTest, GraphWithoutWaysUsesEdges) {
+
+    Parser::GRAPH attached;
+    createGraph(&attached, false);
+
+    DistanceField field;
+    field.build(&attached, &calculator, 1.0, 20, 0);
+    expectDistances(field, 20, 1000);
+}
+
+TEST_F(DistanceFieldTest, MaxCellsCoarsensResolution) {
+
+    DistanceField field;
+    field.build(&graph, &calculator, 0.1, 10, 100000);
+
+    EXPECT_GT(field.getResolution(), 0.1);
+    EXPECT_LE(field.getMemory(), 100000 * 8 + 200 * 64);
+    expectDistances(field, 10, 500);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
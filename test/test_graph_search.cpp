@@ -0,0 +1,182 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/graph_search.h>
+#include "test_graphs.h"
+
+#include <gtest/gtest.h>
+
+using namespace osm_planner;
+
+//distances of integer search in centimetres are compared with the matrix Dijkstra in metres
+template<class Search>
+void expectSameDistances(std::vector<std::vector<float> > *graph, const IntegerGraph &integer_graph) {
+
+    std::vector<std::vector<float> > expected = getAllDistances(graph);
+    Search search;
+
+    for (int s = 0; s < graph->size(); s++) {
+
+        search.findDistances(integer_graph, s);
+        for (int t = 0; t < graph->size(); t++) {
+            if (expected[s][t] == Dijkstra::INFINITY_DISTANCE)
+                EXPECT_EQ(IntegerGraph::INFINITY_WEIGHT, search.getDistance(t)) << s << " -> " << t;
+            else
+                EXPECT_NEAR(expected[s][t], search.getDistance(t) / INTEGER_GRAPH_SCALE, 1e-3) << s << " -> " << t;
+        }
+    }
+}
+
+template<class Search>
+void expectShortestPaths(std::vector<std::vector<float> > *graph, const IntegerGraph &integer_graph) {
+
+    std::vector<std::vector<float> > expected = getAllDistances(graph);
+    Search search;
+
+    for (int s = 0; s < graph->size(); s += 7) {
+        for (int t = 0; t < graph->size(); t++) {
+
+            if (expected[s][t] == Dijkstra::INFINITY_DISTANCE) {
+                EXPECT_THROW(search.findShortestPath(integer_graph, s, t), dijkstra_exception);
+                continue;
+            }
+
+            std::vector<int> path = search.findShortestPath(integer_graph, s, t);
+            EXPECT_EQ(s, path.front());
+            EXPECT_EQ(t, path.back());
+            EXPECT_NEAR(expected[s][t], getPathLength(*graph, path), 1e-3) << s << " -> " << t;
+        }
+    }
+}
+
+TEST(GraphSearch, RadixHeapMatchesDijkstra) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(12, 12, 1);
+    IntegerGraph integer_graph;
+    integer_graph.build(&graph, INTEGER_GRAPH_SCALE);
+
+    expectSameDistances<RadixHeapSearch>(&graph, integer_graph);
+    expectShortestPaths<RadixHeapSearch>(&graph, integer_graph);
+}
+
+TEST(GraphSearch, BucketQueueMatchesDijkstra) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(12, 12, 2);
+    IntegerGraph integer_graph;
+    integer_graph.build(&graph, INTEGER_GRAPH_SCALE);
+
+    expectSameDistances<BucketSearch>(&graph, integer_graph);
+    expectShortestPaths<BucketSearch>(&graph, integer_graph);
+}
+
+TEST(GraphSearch, BinaryHeapMatchesDijkstra) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(10, 10, 3);
+    AdjacencyGraph<float> float_graph;
+    float_graph.build(&graph);
+
+    std::vector<std::vector<float> > expected = getAllDistances(&graph);
+    HeapSearch search;
+    for (int s = 0; s < graph.size(); s++) {
+        search.findDistances(float_graph, s);
+        for (int t = 0; t < graph.size(); t++) {
+            if (expected[s][t] == Dijkstra::INFINITY_DISTANCE)
+                EXPECT_EQ(AdjacencyGraph<float>::INFINITY_WEIGHT, search.getDistance(t));
+            else
+                EXPECT_NEAR(expected[s][t], search.getDistance(t), 1e-2);
+        }
+    }
+}
+
+//the same changes in matrix and adjacency lists give the same distances
+TEST(GraphSearch, ChangedGraphMatchesDijkstra) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(10, 10, 4);
+    IntegerGraph integer_graph;
+    integer_graph.build(&graph, INTEGER_GRAPH_SCALE, 2);
+
+    //deleted edge is only disabled
+    for (int u = 0; u < 20; u++) {
+        for (int v = 0; v < graph.size(); v++) {
+            if (graph[u][v] && v % 3 == 0) {
+                graph[u][v] = graph[v][u] = 0;
+                integer_graph.deleteEdge(u, v);
+                integer_graph.deleteEdge(v, u);
+            }
+        }
+    }
+
+    //removed edge takes the slot of the last one
+    for (int u = 20; u < 40; u++) {
+        for (int v = 0; v < graph.size(); v++) {
+            if (graph[u][v] && v % 4 == 0) {
+                graph[u][v] = graph[v][u] = 0;
+                integer_graph.removeEdge(u, v);
+                integer_graph.removeEdge(v, u);
+            }
+        }
+    }
+
+    //new edges fill the free slots and move full blocks
+    for (int u = 40; u < 60; u++) {
+        int v = (u * 37) % (graph.size() - 1);
+        if (u == v)
+            continue;
+        graph[u][v] = graph[v][u] = 12.34f;
+        integer_graph.setEdge(u, v, 1234);
+        integer_graph.setEdge(v, u, 1234);
+    }
+
+    //new node connects the isolated one
+    int node = integer_graph.addNode();
+    for (int i = 0; i < graph.size(); i++) {
+        graph[i].push_back(0);
+    }
+    graph.push_back(std::vector<float>(node + 1, 0));
+    int isolated = node - 1;
+    graph[node][isolated] = graph[isolated][node] = 5;
+    graph[node][0] = graph[0][node] = 7;
+    integer_graph.setEdge(node, isolated, 500);
+    integer_graph.setEdge(isolated, node, 500);
+    integer_graph.setEdge(node, 0, 700);
+    integer_graph.setEdge(0, node, 700);
+
+    ASSERT_EQ(graph.size(), integer_graph.size());
+    expectSameDistances<RadixHeapSearch>(&graph, integer_graph);
+    expectSameDistances<BucketSearch>(&graph, integer_graph);
+}
+
+TEST(GraphSearch, AttachedArraysAreCopiedBeforeChange) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(5, 5, 5);
+    IntegerGraph owner;
+    owner.build(&graph, INTEGER_GRAPH_SCALE);
+
+    std::vector<int> offsets(owner.size() + 1), targets(owner.getSlots());
+    std::vector<unsigned int> weights(owner.getSlots());
+    for (int u = 0; u < owner.size(); u++) {
+        offsets[u] = owner.begin(u);
+    }
+    offsets[owner.size()] = owner.getSlots();
+    for (int e = 0; e < owner.getSlots(); e++) {
+        targets[e] = owner.target(e);
+        weights[e] = owner.weight(e);
+    }
+
+    IntegerGraph attached;
+    attached.attach(owner.size(), owner.getSlots(), &offsets[0], &offsets[1], &targets[0], &weights[0], owner.getMaxWeight());
+    EXPECT_TRUE(attached.isAttached());
+    EXPECT_EQ(owner.getWeight(0, 1), attached.getWeight(0, 1));
+
+    std::vector<unsigned int> original = weights;
+    attached.deleteEdge(0, 1);
+    EXPECT_FALSE(attached.isAttached());
+    EXPECT_EQ(IntegerGraph::INFINITY_WEIGHT, attached.getWeight(0, 1));
+    EXPECT_EQ(original, weights);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
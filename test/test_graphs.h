@@ -0,0 +1,76 @@
+//
+// Created by michal on 18.10.2026.
+//
+
+#ifndef OSM_TEST_GRAPHS_H
+#define OSM_TEST_GRAPHS_H
+
+#include <osm_planner/dijkstra.h>
+
+#include <random>
+#include <vector>
+
+//Random graphs for tests of search kernels and indexes, they are compared with the matrix Dijkstra.
+
+//undirected grid rows x cols with random lengths in whole centimetres, so integer graphs are exact,
+//some edges are missing and some diagonals are added, the last node is isolated
+inline std::vector<std::vector<float> > createGridGraph(int rows, int cols, unsigned int seed) {
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> centimetres(100, 10000);
+    std::uniform_real_distribution<double> chance(0, 1);
+
+    int size = rows * cols + 1;
+    std::vector<std::vector<float> > graph(size, std::vector<float>(size, 0));
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+
+            int u = r * cols + c;
+            std::vector<int> neighbours;
+            if (c + 1 < cols && chance(generator) < 0.85)
+                neighbours.push_back(u + 1);
+            if (r + 1 < rows && chance(generator) < 0.85)
+                neighbours.push_back(u + cols);
+            if (c + 1 < cols && r + 1 < rows && chance(generator) < 0.1)
+                neighbours.push_back(u + cols + 1);
+
+            for (int i = 0; i < neighbours.size(); i++) {
+                float length = centimetres(generator) / 100.0f;
+                graph[u][neighbours[i]] = length;
+                graph[neighbours[i]][u] = length;
+            }
+        }
+    }
+    return graph;
+}
+
+//distances from every node to all nodes by the matrix Dijkstra, Dijkstra::INFINITY_DISTANCE if unreachable
+inline std::vector<std::vector<float> > getAllDistances(std::vector<std::vector<float> > *graph) {
+
+    std::vector<int> all(graph->size());
+    for (int i = 0; i < all.size(); i++) {
+        all[i] = i;
+    }
+
+    osm_planner::Dijkstra dijkstra;
+    std::vector<std::vector<float> > distances(graph->size());
+    for (int i = 0; i < graph->size(); i++) {
+        distances[i] = dijkstra.findDistances(graph, i, all);
+    }
+    return distances;
+}
+
+//sum of lengths of edges, negative if some edge of path isn't in the graph
+inline double getPathLength(const std::vector<std::vector<float> > &graph, const std::vector<int> &path) {
+
+    double length = 0;
+    for (int i = 1; i < path.size(); i++) {
+        if (!graph[path[i - 1]][path[i]])
+            return -1;
+        length += graph[path[i - 1]][path[i]];
+    }
+    return length;
+}
+
+#endif //OSM_TEST_GRAPHS_H
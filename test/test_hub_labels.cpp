@@ -0,0 +1,72 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/hub_labels.h>
+#include "test_graphs.h"
+
+#include <gtest/gtest.h>
+
+using osm_planner::Dijkstra;
+using osm_planner::HubLabels;
+
+TEST(HubLabels, DistancesMatchDijkstra) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(12, 15, 1);
+    std::vector<std::vector<float> > expected = getAllDistances(&graph);
+
+    HubLabels labels;
+    labels.build(&graph, 1);
+
+    for (int s = 0; s < graph.size(); s++) {
+        for (int t = 0; t < graph.size(); t++) {
+            if (expected[s][t] == Dijkstra::INFINITY_DISTANCE)
+                EXPECT_EQ(Dijkstra::INFINITY_DISTANCE, labels.getDistance(s, t)) << s << " -> " << t;
+            else
+                EXPECT_NEAR(expected[s][t], labels.getDistance(s, t), 1e-3) << s << " -> " << t;
+        }
+    }
+}
+
+TEST(HubLabels, PathsAreShortest) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(10, 10, 2);
+    std::vector<std::vector<float> > expected = getAllDistances(&graph);
+
+    HubLabels labels;
+    labels.build(&graph, 1);
+
+    for (int s = 0; s < graph.size(); s++) {
+        for (int t = 0; t < graph.size(); t++) {
+
+            std::vector<int> path = labels.getPath(s, t);
+            if (expected[s][t] == Dijkstra::INFINITY_DISTANCE) {
+                EXPECT_TRUE(path.empty()) << s << " -> " << t;
+                continue;
+            }
+
+            ASSERT_FALSE(path.empty()) << s << " -> " << t;
+            EXPECT_EQ(s, path.front());
+            EXPECT_EQ(t, path.back());
+            EXPECT_NEAR(expected[s][t], getPathLength(graph, path), 1e-3) << s << " -> " << t;
+        }
+    }
+}
+
+TEST(HubLabels, ReadyOnlyForBuiltVersion) {
+
+    std::vector<std::vector<float> > graph = createGridGraph(4, 4, 3);
+
+    HubLabels labels;
+    EXPECT_FALSE(labels.isReady(0));
+
+    labels.build(&graph, 5);
+    EXPECT_TRUE(labels.isReady(5));
+    EXPECT_FALSE(labels.isReady(6));
+    EXPECT_GT(labels.getLabelsSize(), 0);
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,70 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/next_hop_table.h>
+#include "test_graphs.h"
+
+#include <gtest/gtest.h>
+
+using namespace osm_planner;
+
+//the table walk must give shortest paths of the matrix Dijkstra for every pair
+static void expectAllPairs(int threads) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(12, 14, threads);
+    std::vector<std::vector<float> > expected = getAllDistances(&matrix);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    NextHopTable table;
+    table.build(graph, 1, threads);
+
+    for (int s = 0; s < matrix.size(); s++) {
+        for (int t = 0; t < matrix.size(); t++) {
+
+            std::vector<int> path = table.getPath(s, t);
+            if (expected[s][t] == Dijkstra::INFINITY_DISTANCE) {
+                EXPECT_EQ(Dijkstra::INFINITY_DISTANCE, table.getDistance(s, t)) << s << " -> " << t;
+                EXPECT_TRUE(path.empty()) << s << " -> " << t;
+                continue;
+            }
+
+            EXPECT_NEAR(expected[s][t], table.getDistance(s, t), 1e-3) << s << " -> " << t;
+            ASSERT_FALSE(path.empty()) << s << " -> " << t;
+            EXPECT_EQ(s, path.front());
+            EXPECT_EQ(t, path.back());
+            EXPECT_NEAR(expected[s][t], getPathLength(matrix, path), 1e-3) << s << " -> " << t;
+        }
+    }
+}
+
+TEST(NextHopTable, OneThreadMatchesDijkstra) {
+
+    expectAllPairs(1);
+}
+
+TEST(NextHopTable, ThreadsMatchDijkstra) {
+
+    expectAllPairs(4);
+}
+
+TEST(NextHopTable, ReadyOnlyForBuiltVersion) {
+
+    std::vector<std::vector<float> > matrix = createGridGraph(4, 4, 5);
+    IntegerGraph graph;
+    graph.build(&matrix, INTEGER_GRAPH_SCALE);
+
+    NextHopTable table;
+    EXPECT_FALSE(table.isReady(0));
+
+    table.build(graph, 3);
+    EXPECT_TRUE(table.isReady(3));
+    EXPECT_FALSE(table.isReady(4));
+    EXPECT_EQ((long) matrix.size() * matrix.size() * 8, table.getMemory());
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+//
+// Created by michal on 18.10.2026.
+//
+#include <osm_planner/route_cache.h>
+
+#include <gtest/gtest.h>
+
+using osm_planner::RouteCache;
+
+//route with one node, so entries can be told apart
+static RouteCache::ROUTE createRoute(int node) {
+
+    RouteCache::ROUTE route;
+    route.nodes.push_back(node);
+    route.hasPath = false;
+    return route;
+}
+
+TEST(RouteCache, HitAndMiss) {
+
+    RouteCache cache(10);
+    RouteCache::ROUTE route;
+
+    EXPECT_FALSE(cache.get(1, 2, 1, &route));
+    cache.put(1, 2, 1, createRoute(7));
+
+    ASSERT_TRUE(cache.get(1, 2, 1, &route));
+    EXPECT_EQ(7, route.nodes[0]);
+
+    //direction and version are part of the key
+    EXPECT_FALSE(cache.get(2, 1, 1, &route));
+    EXPECT_FALSE(cache.get(1, 2, 2, &route));
+
+    EXPECT_EQ(1ul, cache.getHits());
+    EXPECT_EQ(3ul, cache.getMisses());
+}
+
+TEST(RouteCache, LeastRecentlyUsedIsEvicted) {
+
+    RouteCache cache(2);
+    RouteCache::ROUTE route;
+
+    cache.put(1, 2, 1, createRoute(1));
+    cache.put(3, 4, 1, createRoute(2));
+
+    //hit moves the first entry to front, so the second one is the oldest
+    EXPECT_TRUE(cache.get(1, 2, 1, &route));
+    cache.put(5, 6, 1, createRoute(3));
+
+    EXPECT_EQ(2, cache.size());
+    EXPECT_TRUE(cache.get(1, 2, 1, &route));
+    EXPECT_FALSE(cache.get(3, 4, 1, &route));
+    EXPECT_TRUE(cache.get(5, 6, 1, &route));
+}
+
+TEST(RouteCache, PutReplacesExistingEntry) {
+
+    RouteCache cache(2);
+    RouteCache::ROUTE route;
+
+    cache.put(1, 2, 1, createRoute(1));
+    cache.put(3, 4, 1, createRoute(2));
+    cache.put(1, 2, 1, createRoute(3));
+
+    EXPECT_EQ(2, cache.size());
+    ASSERT_TRUE(cache.get(1, 2, 1, &route));
+    EXPECT_EQ(3, route.nodes[0]);
+
+    //replaced entry was moved to front
+    cache.put(5, 6, 1, createRoute(4));
+    EXPECT_TRUE(cache.get(1, 2, 1, &route));
+    EXPECT_FALSE(cache.get(3, 4, 1, &route));
+}
+
+TEST(RouteCache, NewerVersionClearsCache) {
+
+    RouteCache cache(10);
+    RouteCache::ROUTE route;
+
+    cache.put(1, 2, 1, createRoute(1));
+    cache.put(3, 4, 1, createRoute(2));
+    cache.put(1, 2, 2, createRoute(3));
+
+    EXPECT_EQ(1, cache.size());
+    EXPECT_FALSE(cache.get(3, 4, 1, &route));
+    ASSERT_TRUE(cache.get(1, 2, 2, &route));
+    EXPECT_EQ(3, route.nodes[0]);
+}
+
+TEST(RouteCache, OlderVersionIsDropped) {
+
+    RouteCache cache(10);
+    RouteCache::ROUTE route;
+
+    cache.put(1, 2, 2, createRoute(1));
+    cache.put(3, 4, 2, createRoute(2));
+
+    //search finished late on older snapshot
+    cache.put(5, 6, 1, createRoute(3));
+
+    EXPECT_EQ(2, cache.size());
+    EXPECT_FALSE(cache.get(5, 6, 1, &route));
+    EXPECT_TRUE(cache.get(1, 2, 2, &route));
+
+    //the current version doesn't clear the cache again
+    cache.put(7, 8, 2, createRoute(4));
+    EXPECT_EQ(3, cache.size());
+    EXPECT_TRUE(cache.get(3, 4, 2, &route));
+}
+
+TEST(RouteCache, MaxEntries) {
+
+    RouteCache cache(4);
+    RouteCache::ROUTE route;
+
+    for (int i = 0; i < 4; i++) {
+        cache.put(i, i + 1, 1, createRoute(i));
+    }
+
+    //the most recently used entries are kept
+    cache.setMaxEntries(2);
+    EXPECT_EQ(2, cache.size());
+    EXPECT_TRUE(cache.get(3, 4, 1, &route));
+    EXPECT_TRUE(cache.get(2, 3, 1, &route));
+    EXPECT_FALSE(cache.get(1, 2, 1, &route));
+
+    //zero disables the cache
+    RouteCache disabled(0);
+    disabled.put(1, 2, 1, createRoute(1));
+    EXPECT_EQ(0, disabled.size());
+    EXPECT_FALSE(disabled.get(1, 2, 1, &route));
+
+    cache.clear();
+    EXPECT_EQ(0, cache.size());
+}
+
+int main(int argc, char **argv) {
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}